@@ -0,0 +1,180 @@
+#include "AdjacencyKernel.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define MINESWEEPER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(MINESWEEPER_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MINESWEEPER_AVX2_DISPATCH 1
+#endif
+
+namespace {
+    // Each row goes through two passes:
+    //   1. vertical: vsum[c + 1] = above[c] + cur[c] + below[c]   (mine bits only, so 0..3 * mineBit)
+    //   2. horizontal: count = vsum[c] + vsum[c + 1] + vsum[c + 2], then blend with the mine bit
+    // vsum carries a zero column on both sides so the edges need no special casing.
+    // mineBit is at most 0x10 in practice, so 9 * mineBit always fits in a byte.
+
+    int mineShift(std::uint8_t mineBit) {
+        int shift = 0;
+        while ((mineBit >> shift) != 1) {
+            shift++;
+        }
+        return shift;
+    }
+
+    void sumRowsScalar(const std::uint8_t *above, const std::uint8_t *cur, const std::uint8_t *below,
+                       std::uint8_t *vsum, int cols, std::uint8_t mineBit) {
+        for (int c = 0; c < cols; c++) {
+            vsum[c + 1] = static_cast<std::uint8_t>((above[c] & mineBit) + (cur[c] & mineBit) + (below[c] & mineBit));
+        }
+    }
+
+    void boxRowScalar(const std::uint8_t *vsum, std::uint8_t *row, int cols, std::uint8_t mineBit,
+                      std::uint8_t keepMask, int from) {
+        int shift = mineShift(mineBit);
+        for (int c = from; c < cols; c++) {
+            std::uint8_t keep = row[c] & keepMask;
+            if (row[c] & mineBit) {
+                row[c] = static_cast<std::uint8_t>(keep | mineBit);
+            } else {
+                row[c] = static_cast<std::uint8_t>(keep | ((vsum[c] + vsum[c + 1] + vsum[c + 2]) >> shift));
+            }
+        }
+    }
+
+#ifdef MINESWEEPER_X86
+    void sumRowsSse2(const std::uint8_t *above, const std::uint8_t *cur, const std::uint8_t *below,
+                     std::uint8_t *vsum, int cols, std::uint8_t mineBit) {
+        const __m128i mask = _mm_set1_epi8(static_cast<char>(mineBit));
+        int c = 0;
+        for (; c + 16 <= cols; c += 16) {
+            __m128i a = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(above + c)), mask);
+            __m128i b = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(cur + c)), mask);
+            __m128i d = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(below + c)), mask);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(vsum + c + 1), _mm_add_epi8(_mm_add_epi8(a, b), d));
+        }
+        sumRowsScalar(above + c, cur + c, below + c, vsum + c, cols - c, mineBit);
+    }
+
+    void boxRowSse2(const std::uint8_t *vsum, std::uint8_t *row, int cols, std::uint8_t mineBit,
+                    std::uint8_t keepMask) {
+        const __m128i mine = _mm_set1_epi8(static_cast<char>(mineBit));
+        const __m128i keep = _mm_set1_epi8(static_cast<char>(keepMask));
+        const __m128i low = _mm_set1_epi8(0x0F);
+        const __m128i shift = _mm_cvtsi32_si128(mineShift(mineBit));
+        int c = 0;
+        for (; c + 16 <= cols; c += 16) {
+            __m128i sum = _mm_add_epi8(_mm_add_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(vsum + c)),
+                                                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(vsum + c + 1))),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(vsum + c + 2)));
+            // No 8-bit shift in SSE2: shift 16-bit lanes and drop the bits pulled in from the high byte
+            __m128i count = _mm_and_si128(_mm_srl_epi16(sum, shift), low);
+            __m128i cell = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + c));
+            __m128i isMine = _mm_cmpeq_epi8(_mm_and_si128(cell, mine), mine);
+            __m128i value = _mm_or_si128(_mm_and_si128(isMine, mine), _mm_andnot_si128(isMine, count));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(row + c), _mm_or_si128(_mm_and_si128(cell, keep), value));
+        }
+        boxRowScalar(vsum, row, cols, mineBit, keepMask, c);
+    }
+#endif
+
+#ifdef MINESWEEPER_AVX2_DISPATCH
+    __attribute__((target("avx2")))
+    void sumRowsAvx2(const std::uint8_t *above, const std::uint8_t *cur, const std::uint8_t *below,
+                     std::uint8_t *vsum, int cols, std::uint8_t mineBit) {
+        const __m256i mask = _mm256_set1_epi8(static_cast<char>(mineBit));
+        int c = 0;
+        for (; c + 32 <= cols; c += 32) {
+            __m256i a = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(above + c)), mask);
+            __m256i b = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(cur + c)), mask);
+            __m256i d = _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(below + c)), mask);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(vsum + c + 1),
+                                _mm256_add_epi8(_mm256_add_epi8(a, b), d));
+        }
+        sumRowsScalar(above + c, cur + c, below + c, vsum + c, cols - c, mineBit);
+    }
+
+    __attribute__((target("avx2")))
+    void boxRowAvx2(const std::uint8_t *vsum, std::uint8_t *row, int cols, std::uint8_t mineBit,
+                    std::uint8_t keepMask) {
+        const __m256i mine = _mm256_set1_epi8(static_cast<char>(mineBit));
+        const __m256i keep = _mm256_set1_epi8(static_cast<char>(keepMask));
+        const __m256i low = _mm256_set1_epi8(0x0F);
+        const __m128i shift = _mm_cvtsi32_si128(mineShift(mineBit));
+        int c = 0;
+        for (; c + 32 <= cols; c += 32) {
+            __m256i sum = _mm256_add_epi8(
+                    _mm256_add_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(vsum + c)),
+                                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(vsum + c + 1))),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(vsum + c + 2)));
+            __m256i count = _mm256_and_si256(_mm256_srl_epi16(sum, shift), low);
+            __m256i cell = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + c));
+            __m256i isMine = _mm256_cmpeq_epi8(_mm256_and_si256(cell, mine), mine);
+            __m256i value = _mm256_blendv_epi8(count, mine, isMine);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + c),
+                                _mm256_or_si256(_mm256_and_si256(cell, keep), value));
+        }
+        boxRowScalar(vsum, row, cols, mineBit, keepMask, c);
+    }
+#endif
+
+    typedef void (*SumRowsFn)(const std::uint8_t *, const std::uint8_t *, const std::uint8_t *, std::uint8_t *, int,
+                              std::uint8_t);
+
+    typedef void (*BoxRowFn)(const std::uint8_t *, std::uint8_t *, int, std::uint8_t, std::uint8_t);
+
+#ifndef MINESWEEPER_X86
+    void boxRowScalarFull(const std::uint8_t *vsum, std::uint8_t *row, int cols, std::uint8_t mineBit,
+                          std::uint8_t keepMask) {
+        boxRowScalar(vsum, row, cols, mineBit, keepMask, 0);
+    }
+#endif
+
+    struct Kernel {
+        SumRowsFn sumRows;
+        BoxRowFn boxRow;
+    };
+
+    Kernel pickKernel() {
+#ifdef MINESWEEPER_AVX2_DISPATCH
+        if (__builtin_cpu_supports("avx2")) {
+            return Kernel{sumRowsAvx2, boxRowAvx2};
+        }
+#endif
+#ifdef MINESWEEPER_X86
+        return Kernel{sumRowsSse2, boxRowSse2};
+#else
+        return Kernel{sumRowsScalar, boxRowScalarFull};
+#endif
+    }
+}
+
+void stencilAdjacency(std::uint8_t *grid, int rows, int cols, std::uint8_t mineBit, std::uint8_t keepMask,
+                      std::vector<std::uint8_t> &scratch, int firstRow, int lastRow) {
+    static const Kernel kernel = pickKernel();
+    firstRow = std::max(firstRow, 0);
+    lastRow = std::min(lastRow, rows - 1);
+    if (firstRow > lastRow || cols <= 0) {
+        return;
+    }
+    // Layout: [previous input row | zero row | vsum with one pad column per side]
+    scratch.assign(3 * static_cast<std::size_t>(cols) + 2, 0);
+    std::uint8_t *previous = scratch.data();
+    std::uint8_t *zeros = previous + cols;
+    std::uint8_t *vsum = zeros + cols;
+    if (firstRow > 0) {
+        std::memcpy(previous, grid + static_cast<std::size_t>(firstRow - 1) * cols, cols);
+    }
+    for (int r = firstRow; r <= lastRow; r++) {
+        std::uint8_t *cur = grid + static_cast<std::size_t>(r) * cols;
+        const std::uint8_t *below = r + 1 < rows ? cur + cols : zeros;
+        // previous holds row r - 1 as it was before being overwritten (all zeros above the grid)
+        kernel.sumRows(previous, cur, below, vsum, cols, mineBit);
+        std::memcpy(previous, cur, cols);
+        kernel.boxRow(vsum, cur, cols, mineBit, keepMask);
+    }
+}
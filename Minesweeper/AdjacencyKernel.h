@@ -0,0 +1,19 @@
+#ifndef MINESWEEPER_ADJACENCYKERNEL_H
+#define MINESWEEPER_ADJACENCYKERNEL_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * 3x3 box-sum stencil over a byte-per-cell mine mask, done in place.
+ * A cell is a mine when (byte & mineBit) != 0. Every cell is rewritten to
+ *   (byte & keepMask) | (mine ? mineBit : number of adjacent mines)
+ * so generation can place mines into the mask first and compute all counts in one streaming pass.
+ * Uses AVX2 or SSE2 when available, with a scalar fallback elsewhere.
+ * Only rows firstRow..lastRow (inclusive) are rewritten; the rows around them are read for context.
+ * scratch is reused between calls to avoid reallocating per board.
+ */
+void stencilAdjacency(std::uint8_t *grid, int rows, int cols, std::uint8_t mineBit, std::uint8_t keepMask,
+                      std::vector<std::uint8_t> &scratch, int firstRow, int lastRow);
+
+#endif //MINESWEEPER_ADJACENCYKERNEL_H
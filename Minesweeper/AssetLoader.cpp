@@ -0,0 +1,144 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include "EmbeddedAssets.h"
+
+AssetLoader::AssetLoader(std::string overrideDir, unsigned threads) : diskDir(std::move(overrideDir)) {
+    if (threads == 0) {
+        threads = std::min(std::max(std::thread::hardware_concurrency(), 1u), 4u);
+    }
+    for (unsigned i = 0; i < threads; i++) {
+        workers.emplace_back(&AssetLoader::workerLoop, this);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+void AssetLoader::loadImage(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    enqueue(name, [this, name](Job &job) {
+        // Embedded images are decoded straight out of the binary; a file's bytes are dropped once decoded
+        const char *data = nullptr;
+        std::size_t size = 0;
+        const bool ok = read(name, job.bytes, data, size) && job.image.loadFromMemory(data, size);
+        std::vector<char>().swap(job.bytes);
+        return ok;
+    });
+}
+
+void AssetLoader::loadFile(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    enqueue(name, [this, name](Job &job) {
+        const char *data = nullptr;
+        std::size_t size = 0;
+        if (!read(name, job.bytes, data, size)) {
+            return false;
+        }
+        job.bytes.assign(data, data + size);
+        return true;
+    });
+}
+
+void AssetLoader::run(const std::string &name, std::function<bool()> task) {
+    std::lock_guard<std::mutex> lock(mutex);
+    enqueue(name, [task](Job &) {
+        return task();
+    });
+}
+
+const sf::Image *AssetLoader::image(const std::string &name) {
+    loadImage(name);
+    std::unique_lock<std::mutex> lock(mutex);
+    Job &job = await(*jobs[name], lock);
+    return job.ok ? &job.image : nullptr;
+}
+
+const std::vector<char> *AssetLoader::file(const std::string &name) {
+    loadFile(name);
+    std::unique_lock<std::mutex> lock(mutex);
+    Job &job = await(*jobs[name], lock);
+    return job.ok ? &job.bytes : nullptr;
+}
+
+bool AssetLoader::wait(const std::string &name) {
+    std::unique_lock<std::mutex> lock(mutex);
+    auto found = jobs.find(name);
+    return found != jobs.end() && await(*found->second, lock).ok;
+}
+
+bool AssetLoader::read(const std::string &name, std::vector<char> &storage, const char *&data,
+                       std::size_t &size) const {
+    if (!diskDir.empty()) {
+        std::ifstream in(diskDir + name, std::ios::binary);
+        if (in) {
+            storage.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+            data = storage.data();
+            size = storage.size();
+            return true;
+        }
+    }
+    const EmbeddedAsset *asset = findEmbeddedAsset(name);
+    if (!asset) {
+        return false;
+    }
+    data = reinterpret_cast<const char *>(asset->data);
+    size = asset->size;
+    return true;
+}
+
+AssetLoader::Job &AssetLoader::enqueue(const std::string &name, std::function<bool(Job &)> work) {
+    std::unique_ptr<Job> &slot = jobs[name];
+    if (!slot) {
+        slot.reset(new Job());
+        slot->work = std::move(work);
+        queue.push_back(slot.get());
+        wake.notify_one();
+    }
+    return *slot;
+}
+
+AssetLoader::Job &AssetLoader::await(Job &job, std::unique_lock<std::mutex> &lock) {
+    if (job.state == Job::Queued) {
+        // Left in the queue; workers skip jobs that are no longer Queued
+        execute(job, lock);
+    }
+    finished.wait(lock, [&job] { return job.state == Job::Done; });
+    return job;
+}
+
+void AssetLoader::execute(Job &job, std::unique_lock<std::mutex> &lock) {
+    job.state = Job::Running;
+    lock.unlock();
+    const bool ok = job.work(job);
+    lock.lock();
+    job.ok = ok;
+    job.state = Job::Done;
+    job.work = nullptr;
+    finished.notify_all();
+}
+
+void AssetLoader::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+        Job *job = queue.front();
+        queue.pop_front();
+        if (job->state == Job::Queued) {
+            execute(*job, lock);
+        }
+    }
+}
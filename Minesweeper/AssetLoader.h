@@ -0,0 +1,95 @@
+#ifndef MINESWEEPER_ASSETLOADER_H
+#define MINESWEEPER_ASSETLOADER_H
+
+#include <SFML/Graphics.hpp>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Reads and decodes asset files on a small pool of worker threads, so the work overlaps with whatever
+ * the main thread is doing (the welcome screen) instead of running after it.
+ * Assets are named by their path relative to the asset directory ("font.ttf", "images/mine.png") and come
+ * from the copies embedded in the binary (see EmbeddedAssets.h); with an override directory,
+ * a file present there is used instead, so assets can be swapped without rebuilding.
+ * Everything produced here is CPU-side (sf::Image pixels, raw file bytes); creating textures and fonts
+ * from it is left to the main thread, which owns the GL context.
+ * Requests are keyed by path and queued in order. Asking for a result waits until it is ready;
+ * if no worker has picked the request up yet, the asking thread does it itself, so a task running
+ * on the pool can wait on other requests without tying up the workers.
+ */
+class AssetLoader {
+public:
+    // overrideDir (ending in '/') is searched before the embedded assets; empty means embedded only.
+    // threads == 0 uses one per core, at most 4.
+    explicit AssetLoader(std::string overrideDir = std::string(), unsigned threads = 0);
+
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader &) = delete;
+
+    AssetLoader &operator=(const AssetLoader &) = delete;
+
+    const std::string &overrideDir() const { return diskDir; }
+
+    // Queues decoding an image (repeated requests for the same name are ignored)
+    void loadImage(const std::string &name);
+
+    // Queues getting a whole file's bytes
+    void loadFile(const std::string &name);
+
+    // Queues an arbitrary task under a name; it returns whether it succeeded
+    void run(const std::string &name, std::function<bool()> task);
+
+    // The decoded image, or nullptr if it could not be loaded. Queues the request if it wasn't.
+    const sf::Image *image(const std::string &name);
+
+    // The file's bytes, or nullptr if there is no such asset. Queues the request if it wasn't.
+    const std::vector<char> *file(const std::string &name);
+
+    // Whether the named task succeeded; false if no such task was queued
+    bool wait(const std::string &name);
+
+private:
+    struct Job {
+        enum State {
+            Queued, Running, Done
+        };
+        std::function<bool(Job &)> work;
+        State state = Queued;
+        bool ok = false;
+        sf::Image image;
+        std::vector<char> bytes;
+    };
+
+    const std::string diskDir;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::map<std::string, std::unique_ptr<Job>> jobs;
+    std::deque<Job *> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    // Points data at the asset's bytes: read into storage from the override directory, or else the embedded copy
+    bool read(const std::string &name, std::vector<char> &storage, const char *&data, std::size_t &size) const;
+
+    // Adds a job unless one with that name exists; returns the job either way. Expects the lock held.
+    Job &enqueue(const std::string &name, std::function<bool(Job &)> work);
+
+    // Waits for the job to finish, running it here if it hasn't started
+    Job &await(Job &job, std::unique_lock<std::mutex> &lock);
+
+    // Runs a job outside the lock and marks it done
+    void execute(Job &job, std::unique_lock<std::mutex> &lock);
+
+    void workerLoop();
+};
+
+#endif //MINESWEEPER_ASSETLOADER_H
@@ -0,0 +1,217 @@
+#include "Atlas.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include "AssetLoader.h"
+#include "EmbeddedAssets.h"
+
+constexpr int Atlas::DIGIT_WIDTH;
+constexpr int Atlas::MINUS_DIGIT;
+
+namespace {
+    // Bump when the layout or composition changes so stale caches are rebuilt
+    const int CACHE_VERSION = 1;
+    // Atlas rows are packed up to this width (or the widest image, if wider)
+    const int SHELF_WIDTH = 512;
+    // Gap between entries so filtering at fractional zoom never samples a neighbour
+    const int PADDING = 1;
+
+    // An atlas entry is its base image with up to two overlays alpha-blended on top
+    struct Source {
+        const char *base;
+        const char *overlay1;
+        const char *overlay2;
+    };
+
+    // Indexed by Atlas::Id
+    const Source SOURCES[] = {
+            {"tile_hidden.png",   nullptr,          nullptr},
+            {"tile_revealed.png", nullptr,          nullptr},
+            {"tile_revealed.png", "number_1.png",   nullptr},
+            {"tile_revealed.png", "number_2.png",   nullptr},
+            {"tile_revealed.png", "number_3.png",   nullptr},
+            {"tile_revealed.png", "number_4.png",   nullptr},
+            {"tile_revealed.png", "number_5.png",   nullptr},
+            {"tile_revealed.png", "number_6.png",   nullptr},
+            {"tile_revealed.png", "number_7.png",   nullptr},
+            {"tile_revealed.png", "number_8.png",   nullptr},
+            {"tile_revealed.png", "mine.png",       nullptr},
+            {"tile_hidden.png",   "flag.png",       nullptr},
+            {"tile_hidden.png",   "mine.png",       nullptr},
+            {"tile_hidden.png",   "mine.png",       "flag.png"},
+            {"face_happy.png",    nullptr,          nullptr},
+            {"face_win.png",      nullptr,          nullptr},
+            {"face_lose.png",     nullptr,          nullptr},
+            {"digits.png",        nullptr,          nullptr},
+            {"debug.png",         nullptr,          nullptr},
+            {"pause.png",         nullptr,          nullptr},
+            {"play.png",          nullptr,          nullptr},
+            {"leaderboard.png",   nullptr,          nullptr},
+    };
+    static_assert(sizeof(SOURCES) / sizeof(SOURCES[0]) == Atlas::Count, "SOURCES must have one entry per Atlas::Id");
+
+    void fnv1a(unsigned long long &hash, const void *data, std::size_t length) {
+        const unsigned char *bytes = static_cast<const unsigned char *>(data);
+        for (std::size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    }
+
+    // Hashes the name, mtime and size of every source file; any edit to an image changes the key.
+    // Images not in the override directory come from the binary and are keyed by their embedded size.
+    unsigned long long sourceKey(const std::string &imageDir, const std::string &diskDir) {
+        unsigned long long hash = 14695981039346656037ULL;
+        fnv1a(hash, &CACHE_VERSION, sizeof(CACHE_VERSION));
+        for (const Source &source : SOURCES) {
+            for (const char *name : {source.base, source.overlay1, source.overlay2}) {
+                if (!name) {
+                    continue;
+                }
+                struct stat info = {};
+                long long stamp[2] = {-1, -1};
+                const EmbeddedAsset *embedded = findEmbeddedAsset(imageDir + name);
+                if (stat((diskDir + imageDir + name).c_str(), &info) == 0) {
+                    stamp[0] = static_cast<long long>(info.st_mtime);
+                    stamp[1] = static_cast<long long>(info.st_size);
+                } else if (embedded) {
+                    stamp[1] = static_cast<long long>(embedded->size);
+                }
+                fnv1a(hash, name, std::char_traits<char>::length(name));
+                fnv1a(hash, stamp, sizeof(stamp));
+            }
+        }
+        return hash;
+    }
+}
+
+bool Atlas::compose(const std::string &imageDir, const std::string &cachePath, AssetLoader &loader) {
+    if (cachePath.empty()) {
+        return build(imageDir, loader, packed);
+    }
+    const unsigned long long key = sourceKey(imageDir, loader.overrideDir());
+    if (!readCache(cachePath, key, packed)) {
+        if (!build(imageDir, loader, packed)) {
+            return false;
+        }
+        writeCache(cachePath, key, packed);
+    }
+    return true;
+}
+
+bool Atlas::upload() {
+    const bool ok = atlas.loadFromImage(packed);
+    packed = sf::Image();
+    return ok;
+}
+
+sf::IntRect Atlas::digit(int value) const {
+    const sf::IntRect &sheet = rects[Digits];
+    return sf::IntRect(sheet.left + value * DIGIT_WIDTH, sheet.top, DIGIT_WIDTH, sheet.height);
+}
+
+bool Atlas::build(const std::string &imageDir, AssetLoader &loader, sf::Image &image) {
+    // Queue every file first so the pool decodes them side by side, then collect them in order.
+    // Each file is decoded once even if several entries use it.
+    for (const Source &source : SOURCES) {
+        for (const char *name : {source.base, source.overlay1, source.overlay2}) {
+            if (name) {
+                loader.loadImage(imageDir + name);
+            }
+        }
+    }
+    std::map<std::string, const sf::Image *> files;
+    for (const Source &source : SOURCES) {
+        for (const char *name : {source.base, source.overlay1, source.overlay2}) {
+            if (name && !files.count(name) && !(files[name] = loader.image(imageDir + name))) {
+                std::cerr << "Failed to load " << imageDir << name << "!" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Shelf packing: tallest entries first, left to right, starting a new row when one is full
+    int order[Count];
+    int shelfWidth = SHELF_WIDTH;
+    for (int id = 0; id < Count; id++) {
+        order[id] = id;
+        sf::Vector2u size = files[SOURCES[id].base]->getSize();
+        rects[id] = sf::IntRect(0, 0, (int) size.x, (int) size.y);
+        shelfWidth = std::max(shelfWidth, rects[id].width);
+    }
+    std::stable_sort(order, order + Count, [this](int a, int b) {
+        return rects[a].height > rects[b].height;
+    });
+    int x = 0, y = 0, shelfHeight = 0;
+    for (int id : order) {
+        sf::IntRect &rect = rects[id];
+        if (x + rect.width > shelfWidth) {
+            x = 0;
+            y += shelfHeight + PADDING;
+            shelfHeight = 0;
+        }
+        rect.left = x;
+        rect.top = y;
+        x += rect.width + PADDING;
+        shelfHeight = std::max(shelfHeight, rect.height);
+    }
+
+    image.create((unsigned) shelfWidth, (unsigned) (y + shelfHeight), sf::Color::Transparent);
+    for (int id = 0; id < Count; id++) {
+        const Source &source = SOURCES[id];
+        const unsigned left = (unsigned) rects[id].left;
+        const unsigned top = (unsigned) rects[id].top;
+        image.copy(*files[source.base], left, top);
+        for (const char *overlay : {source.overlay1, source.overlay2}) {
+            if (overlay) {
+                image.copy(*files[overlay], left, top, sf::IntRect(0, 0, 0, 0), true);
+            }
+        }
+    }
+    return true;
+}
+
+bool Atlas::readCache(const std::string &cachePath, unsigned long long key, sf::Image &image) {
+    std::ifstream index(cachePath + ".txt");
+    int version = 0;
+    unsigned long long cachedKey = 0;
+    if (!(index >> version >> cachedKey) || version != CACHE_VERSION || cachedKey != key) {
+        return false;
+    }
+    sf::IntRect cached[Count];
+    for (sf::IntRect &rect : cached) {
+        if (!(index >> rect.left >> rect.top >> rect.width >> rect.height)) {
+            return false;
+        }
+    }
+    // sf::Image reports its own failure on stderr; a missing cache is not an error worth showing
+    std::ifstream png(cachePath + ".png", std::ios::binary);
+    if (!png || !image.loadFromFile(cachePath + ".png")) {
+        return false;
+    }
+    const sf::Vector2u size = image.getSize();
+    for (const sf::IntRect &rect : cached) {
+        if (rect.left < 0 || rect.top < 0 || rect.left + rect.width > (int) size.x ||
+            rect.top + rect.height > (int) size.y) {
+            return false;
+        }
+    }
+    std::copy(cached, cached + Count, rects);
+    return true;
+}
+
+void Atlas::writeCache(const std::string &cachePath, unsigned long long key, const sf::Image &image) const {
+    // The old index goes first and the new one is written last, so an interrupted write is never trusted
+    std::remove((cachePath + ".txt").c_str());
+    if (!image.saveToFile(cachePath + ".png")) {
+        return;
+    }
+    std::ofstream index(cachePath + ".txt");
+    index << CACHE_VERSION << ' ' << key << '\n';
+    for (const sf::IntRect &rect : rects) {
+        index << rect.left << ' ' << rect.top << ' ' << rect.width << ' ' << rect.height << '\n';
+    }
+}
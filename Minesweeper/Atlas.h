@@ -0,0 +1,74 @@
+#ifndef MINESWEEPER_ATLAS_H
+#define MINESWEEPER_ATLAS_H
+
+#include <SFML/Graphics.hpp>
+#include <string>
+
+class AssetLoader;
+
+/**
+ * Packs every tile and HUD image into one texture, so a whole frame can be drawn without switching textures.
+ * Each sprite is addressed by a compile-time Id into a table of sub-rects.
+ * Tile looks that are drawn layered (a number on a revealed tile, a flag over a mine in debug mode, ...)
+ * are pre-composed into their own entry, so every tile is exactly one quad.
+ * The packed image can be cached on disk and only rebuilt when a source PNG changes.
+ * Loading is split in two so the decoding can happen off the main thread: compose() builds the
+ * packed image in memory, and upload() turns it into the texture on the thread that owns the GL context.
+ */
+class Atlas {
+public:
+    enum Id : int {
+        TileHidden,
+        TileRevealed,
+        Number1,    // Number1..Number8 are consecutive
+        Mine = Number1 + 8,
+        Flag,
+        DebugMine,
+        DebugMineFlag,
+        FaceHappy,
+        FaceWin,
+        FaceLose,
+        Digits,     // Sheet of 21px wide digits 0-9 followed by the minus sign
+        Debug,
+        Pause,
+        Play,
+        Leaderboard,
+        Count
+    };
+
+    static constexpr int DIGIT_WIDTH = 21;
+    static constexpr int MINUS_DIGIT = 10;
+
+    /**
+     * Builds the packed image for the PNGs in imageDir (an asset name prefix, e.g. "images/"), without touching
+     * the GPU. The packed image is read from cachePath (+ ".png"/".txt") when it is newer than all sources,
+     * otherwise the sources are decoded through loader, packed, and written back there.
+     * An empty cachePath always builds and touches no files.
+     * Returns false if a source image is missing. Safe to run on a worker thread.
+     */
+    bool compose(const std::string &imageDir, const std::string &cachePath, AssetLoader &loader);
+
+    // Creates the texture from the composed image and frees the image. Main thread only.
+    bool upload();
+
+    const sf::Texture &texture() const { return atlas; }
+
+    const sf::IntRect &rect(Id id) const { return rects[id]; }
+
+    // Sub-rect of one glyph of the Digits sheet (MINUS_DIGIT for the minus sign)
+    sf::IntRect digit(int value) const;
+
+private:
+    sf::Texture atlas;
+    sf::IntRect rects[Count];
+    // Output of compose() waiting for upload()
+    sf::Image packed;
+
+    bool build(const std::string &imageDir, AssetLoader &loader, sf::Image &image);
+
+    bool readCache(const std::string &cachePath, unsigned long long key, sf::Image &image);
+
+    void writeCache(const std::string &cachePath, unsigned long long key, const sf::Image &image) const;
+};
+
+#endif //MINESWEEPER_ATLAS_H
@@ -0,0 +1,252 @@
+#include "BitBoard.h"
+#include <algorithm>
+#include <bitset>
+
+namespace {
+    typedef std::uint64_t Word;
+
+    // Occluded fill: spreads gen bits towards the high end through set bits of pro, log2(64) steps
+    Word fillUp(Word gen, Word pro) {
+        gen |= pro & (gen << 1);
+        pro &= pro << 1;
+        gen |= pro & (gen << 2);
+        pro &= pro << 2;
+        gen |= pro & (gen << 4);
+        pro &= pro << 4;
+        gen |= pro & (gen << 8);
+        pro &= pro << 8;
+        gen |= pro & (gen << 16);
+        pro &= pro << 16;
+        gen |= pro & (gen << 32);
+        return gen;
+    }
+
+    // Same as fillUp, towards the low end
+    Word fillDown(Word gen, Word pro) {
+        gen |= pro & (gen >> 1);
+        pro &= pro >> 1;
+        gen |= pro & (gen >> 2);
+        pro &= pro >> 2;
+        gen |= pro & (gen >> 4);
+        pro &= pro >> 4;
+        gen |= pro & (gen >> 8);
+        pro &= pro >> 8;
+        gen |= pro & (gen >> 16);
+        pro &= pro >> 16;
+        gen |= pro & (gen >> 32);
+        return gen;
+    }
+
+    int popCount(Word w) {
+        return static_cast<int>(std::bitset<64>(w).count());
+    }
+}
+
+void BitBoard::reset(int rows, int cols) {
+    numRows = rows;
+    numCols = cols;
+    wordsPerRow = (cols + 63) / 64;
+    lastWordMask = (cols % 64 == 0) ? ~Word(0) : (Word(1) << (cols % 64)) - 1;
+    std::size_t words = static_cast<std::size_t>(rows) * wordsPerRow;
+    mines.assign(words, 0);
+    revealed.assign(words, 0);
+    flagged.assign(words, 0);
+    for (auto &plane: countPlanes) {
+        plane.assign(words, 0);
+    }
+    // Flood fill scratch is kept for a board of the same size (a fill leaves it all zero), rebuilt lazily otherwise
+    if (region.size() != words) {
+        std::vector<Word>().swap(region);
+        std::vector<Word>().swap(rowScratch);
+        std::vector<int>().swap(rowQueue);
+        std::vector<char>().swap(rowQueued);
+    }
+}
+
+int BitBoard::adjacentMines(int r, int c) const {
+    if (isMine(r, c)) {
+        return 0;
+    }
+    int count = 0;
+    for (int k = 0; k < 4; k++) {
+        count |= static_cast<int>(test(countPlanes[k], r, c)) << k;
+    }
+    return count;
+}
+
+TileState BitBoard::state(int r, int c) const {
+    if (test(revealed, r, c)) {
+        return TileState::Revealed;
+    }
+    return test(flagged, r, c) ? TileState::Flagged : TileState::Hidden;
+}
+
+void BitBoard::setState(int r, int c, TileState s) {
+    assign(revealed, r, c, s == TileState::Revealed);
+    assign(flagged, r, c, s == TileState::Flagged);
+}
+
+void BitBoard::computeAdjacency(int firstRow, int lastRow) {
+    firstRow = std::max(firstRow, 0);
+    lastRow = std::min(lastRow, numRows - 1);
+    if (firstRow > lastRow) {
+        return;
+    }
+    for (auto &plane: countPlanes) {
+        std::fill(row(plane, firstRow), row(plane, lastRow) + wordsPerRow, Word(0));
+    }
+    for (int r = firstRow; r <= lastRow; r++) {
+        for (int k = r - 1; k <= r + 1; k++) {
+            if (k < 0 || k >= numRows) {
+                continue;
+            }
+            const Word *src = row(mines, k);
+            for (int w = 0; w < wordsPerRow; w++) {
+                // The eight neighbours as shifted copies of the mine rows (the cell itself is not counted)
+                Word west = (src[w] << 1) | (w > 0 ? src[w - 1] >> 63 : 0);
+                Word east = (src[w] >> 1) | (w + 1 < wordsPerRow ? src[w + 1] << 63 : 0);
+                Word shifted[3] = {west, east, k != r ? src[w] : 0};
+                std::size_t i = static_cast<std::size_t>(r) * wordsPerRow + w;
+                for (int s = 0; s < 3; s++) {
+                    // Ripple-carry add of one bit per cell into the bit-sliced counter
+                    Word carry = shifted[s];
+                    for (auto &plane: countPlanes) {
+                        Word next = plane[i] & carry;
+                        plane[i] ^= carry;
+                        carry = next;
+                    }
+                }
+            }
+        }
+        std::size_t last = static_cast<std::size_t>(r) * wordsPerRow + wordsPerRow - 1;
+        for (auto &plane: countPlanes) {
+            plane[last] &= lastWordMask;
+        }
+    }
+}
+
+BitBoard::Word BitBoard::openWord(int r, int w) const {
+    std::size_t i = static_cast<std::size_t>(r) * wordsPerRow + w;
+    Word open = ~(countPlanes[0][i] | countPlanes[1][i] | countPlanes[2][i] | countPlanes[3][i]);
+    open &= ~mines[i] & ~revealed[i];
+    return w == wordsPerRow - 1 ? open & lastWordMask : open;
+}
+
+void BitBoard::dilateRow(const Word *src, Word *dst) const {
+    for (int w = 0; w < wordsPerRow; w++) {
+        Word x = src[w];
+        Word up = (x << 1) | (w > 0 ? src[w - 1] >> 63 : 0);
+        Word down = (x >> 1) | (w + 1 < wordsPerRow ? src[w + 1] << 63 : 0);
+        dst[w] = x | up | down;
+    }
+    dst[wordsPerRow - 1] &= lastWordMask;
+}
+
+void BitBoard::fillRow(Word *seed, int r) const {
+    // Left to right: fill each word, then carry into the next word if the run continues there
+    for (int w = 0; w < wordsPerRow; w++) {
+        Word open = openWord(r, w);
+        seed[w] = fillUp(seed[w], open) | fillDown(seed[w], open);
+        if (w + 1 < wordsPerRow && (seed[w] >> 63) && (openWord(r, w + 1) & 1)) {
+            seed[w + 1] |= 1;
+        }
+    }
+    // Right to left: carry runs that continue below a word boundary
+    for (int w = wordsPerRow - 1; w > 0; w--) {
+        Word open = openWord(r, w - 1);
+        if ((seed[w] & 1) && (open >> 63) && !(seed[w - 1] >> 63)) {
+            seed[w - 1] = fillDown(seed[w - 1] | (Word(1) << 63), open);
+        }
+    }
+}
+
+int BitBoard::floodReveal(int r, int c, CellRect &changed) {
+    changed = CellRect{r, c, r, c};
+    if (test(revealed, r, c) || isMine(r, c)) {
+        return 0;
+    }
+    if (adjacentMines(r, c) != 0) {
+        if (test(flagged, r, c)) {
+            return 0;
+        }
+        assign(revealed, r, c, true);
+        return 1;
+    }
+    if (region.size() != static_cast<std::size_t>(numRows) * wordsPerRow) {
+        region.assign(static_cast<std::size_t>(numRows) * wordsPerRow, 0);
+        rowScratch.assign(2 * static_cast<std::size_t>(wordsPerRow), 0);
+        rowQueue.clear();
+        rowQueue.reserve(numRows);
+        rowQueued.assign(numRows, 0);
+    }
+    // Grow the connected region of open cells, one row of words at a time
+    assign(region, r, c, true);
+    int minRow = r, maxRow = r;
+    for (int j = std::max(r - 1, 0); j <= std::min(r + 1, numRows - 1); j++) {
+        rowQueue.push_back(j);
+        rowQueued[j] = 1;
+    }
+    Word *seed = rowScratch.data();
+    Word *neighbours = seed + wordsPerRow;
+    while (!rowQueue.empty()) {
+        int j = rowQueue.back();
+        rowQueue.pop_back();
+        rowQueued[j] = 0;
+        // Seeds for this row: its own region plus anything diagonally/vertically adjacent to the rows around it
+        std::fill(neighbours, neighbours + wordsPerRow, Word(0));
+        for (int k = j - 1; k <= j + 1; k += 2) {
+            if (k >= 0 && k < numRows) {
+                const Word *other = row(region, k);
+                for (int w = 0; w < wordsPerRow; w++) {
+                    neighbours[w] |= other[w];
+                }
+            }
+        }
+        dilateRow(neighbours, seed);
+        Word *current = row(region, j);
+        for (int w = 0; w < wordsPerRow; w++) {
+            seed[w] = (seed[w] & openWord(j, w)) | current[w];
+        }
+        fillRow(seed, j);
+        if (!std::equal(seed, seed + wordsPerRow, current)) {
+            std::copy(seed, seed + wordsPerRow, current);
+            minRow = std::min(minRow, j);
+            maxRow = std::max(maxRow, j);
+            for (int k = j - 1; k <= j + 1; k += 2) {
+                if (k >= 0 && k < numRows && !rowQueued[k]) {
+                    rowQueue.push_back(k);
+                    rowQueued[k] = 1;
+                }
+            }
+        }
+    }
+    // Reveal the region plus its one-cell border, skipping mines, flags and tiles that are already open
+    int count = 0;
+    int firstWord = c >> 6, lastWord = c >> 6;
+    for (int j = std::max(minRow - 1, 0); j <= std::min(maxRow + 1, numRows - 1); j++) {
+        std::fill(neighbours, neighbours + wordsPerRow, Word(0));
+        for (int k = std::max(j - 1, minRow); k <= std::min(j + 1, maxRow); k++) {
+            const Word *other = row(region, k);
+            for (int w = 0; w < wordsPerRow; w++) {
+                neighbours[w] |= other[w];
+            }
+        }
+        dilateRow(neighbours, seed);
+        Word *rev = row(revealed, j);
+        const Word *mine = row(mines, j);
+        const Word *flag = row(flagged, j);
+        for (int w = 0; w < wordsPerRow; w++) {
+            Word fresh = seed[w] & ~mine[w] & ~flag[w] & ~rev[w];
+            rev[w] |= fresh;
+            count += popCount(fresh);
+            if (fresh) {
+                firstWord = std::min(firstWord, w);
+                lastWord = std::max(lastWord, w);
+            }
+        }
+    }
+    changed = CellRect{std::max(minRow - 1, 0), firstWord * 64, std::min(maxRow + 1, numRows - 1),
+                       std::min(lastWord * 64 + 63, numCols - 1)};
+    std::fill(row(region, minRow), row(region, maxRow) + wordsPerRow, Word(0));
+    return count;
+}
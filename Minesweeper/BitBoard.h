@@ -0,0 +1,124 @@
+#ifndef MINESWEEPER_BITBOARD_H
+#define MINESWEEPER_BITBOARD_H
+
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+
+/**
+ * Bit-parallel board backend with the same interface as Board.
+ * Each plane (mines, revealed, flagged and the four bit-sliced adjacency count planes)
+ * is stored row by row as packed 64-bit words, so neighbour counting and the reveal
+ * flood fill run as shift/and/or operations over 64 cells at a time.
+ * Select it at build time with -DMINESWEEPER_BITBOARD=ON.
+ */
+class BitBoard {
+public:
+    BitBoard() = default;
+
+    BitBoard(int numRows, int numCols) {
+        reset(numRows, numCols);
+    }
+
+    // Resize the grid (if needed) and clear every cell to a hidden, mine-free tile
+    void reset(int numRows, int numCols);
+
+    int rows() const { return numRows; }
+
+    int cols() const { return numCols; }
+
+    int size() const { return numRows * numCols; }
+
+    int index(int row, int col) const { return row * numCols + col; }
+
+    bool inBounds(int row, int col) const { return row >= 0 && row < numRows && col >= 0 && col < numCols; }
+
+    bool isMine(int i) const { return isMine(i / numCols, i % numCols); }
+
+    bool isMine(int row, int col) const { return test(mines, row, col); }
+
+    int adjacentMines(int i) const { return adjacentMines(i / numCols, i % numCols); }
+
+    int adjacentMines(int row, int col) const;
+
+    TileState state(int i) const { return state(i / numCols, i % numCols); }
+
+    TileState state(int row, int col) const;
+
+    void setState(int i, TileState s) { setState(i / numCols, i % numCols, s); }
+
+    void setState(int row, int col, TileState s);
+
+    // Generation stage 1: set the mine bit only. Counts are stale until computeAdjacency() runs.
+    void setMine(int i) { setMine(i / numCols, i % numCols); }
+
+    void setMine(int row, int col) { assign(mines, row, col, true); }
+
+    void clearMine(int i) { assign(mines, i / numCols, i % numCols, false); }
+
+    // Generation stage 2: rebuild the bit-sliced count planes from the mine plane, 64 cells per word operation
+    void computeAdjacency() { computeAdjacency(0, numRows - 1); }
+
+    // Same, limited to rows firstRow..lastRow, e.g. after moving a few mines
+    void computeAdjacency(int firstRow, int lastRow);
+
+    // Reveals the opening around (row, col) by dilating whole rows of words at a time.
+    // Returns the number of tiles newly revealed and sets changed to (word-aligned) bounds of the tiles touched.
+    int floodReveal(int row, int col, CellRect &changed);
+
+    // Trades flood fill scratch with a board of the same size (see Board::swapScratch)
+    void swapScratch(BitBoard &other) {
+        region.swap(other.region);
+        rowScratch.swap(other.rowScratch);
+        rowQueue.swap(other.rowQueue);
+        rowQueued.swap(other.rowQueued);
+    }
+
+private:
+    typedef std::uint64_t Word;
+
+    int numRows = 0;
+    int numCols = 0;
+    int wordsPerRow = 0;
+    // Bits past numCols in the last word of a row are always zero
+    Word lastWordMask = 0;
+
+    std::vector<Word> mines;
+    std::vector<Word> revealed;
+    std::vector<Word> flagged;
+    // Adjacent mine count, one bit per plane (counts go up to 8, so 4 planes)
+    std::vector<Word> countPlanes[4];
+    // Flood fill scratch: the connected zero region grown from the clicked cell, and the rows still to grow.
+    // Built together by the first floodReveal, so boards that are never clicked (pooled ones) don't carry them.
+    std::vector<Word> region;
+    std::vector<Word> rowScratch;
+    std::vector<int> rowQueue;
+    std::vector<char> rowQueued;
+
+    Word *row(std::vector<Word> &plane, int r) { return &plane[static_cast<std::size_t>(r) * wordsPerRow]; }
+
+    const Word *row(const std::vector<Word> &plane, int r) const {
+        return &plane[static_cast<std::size_t>(r) * wordsPerRow];
+    }
+
+    bool test(const std::vector<Word> &plane, int r, int c) const {
+        return (row(plane, r)[c >> 6] >> (c & 63)) & 1;
+    }
+
+    void assign(std::vector<Word> &plane, int r, int c, bool value) {
+        Word bit = Word(1) << (c & 63);
+        Word &w = row(plane, r)[c >> 6];
+        w = value ? (w | bit) : (w & ~bit);
+    }
+
+    // Cells with no adjacent mines that are neither mines nor already revealed
+    Word openWord(int r, int w) const;
+
+    // Horizontal 3-wide dilation of one row (x | x<<1 | x>>1, carrying across word boundaries); src != dst
+    void dilateRow(const Word *src, Word *dst) const;
+
+    // Grows seed bits along runs of open cells within one row
+    void fillRow(Word *seed, int r) const;
+};
+
+#endif //MINESWEEPER_BITBOARD_H
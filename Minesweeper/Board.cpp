@@ -0,0 +1,103 @@
+#include "Board.h"
+#include <algorithm>
+#include "AdjacencyKernel.h"
+
+const std::uint8_t Board::COUNT_MASK;
+const std::uint8_t Board::MINE_BIT;
+const std::uint8_t Board::STATE_MASK;
+const int Board::STATE_SHIFT;
+
+namespace {
+    // Starting ring size for the flood fill frontier; a power of two
+    const std::size_t INITIAL_FILL_QUEUE = 1024;
+}
+
+void Board::reset(int rows, int cols) {
+    numRows = rows;
+    numCols = cols;
+    // assign() keeps the existing capacity, so restarting a game does not reallocate
+    cells.assign(static_cast<std::size_t>(rows) * cols, 0);
+    // The fill scratch is kept for a board of the same size and rebuilt lazily for any other
+    if (visited.size() != (cells.size() + 63) / 64) {
+        std::vector<std::uint64_t>().swap(visited);
+    }
+}
+
+void Board::computeAdjacency(int firstRow, int lastRow) {
+    stencilAdjacency(cells.data(), numRows, numCols, MINE_BIT, STATE_MASK, stencilScratch, firstRow, lastRow);
+}
+
+// (r-1)(c-1)       (r-1)c      (r-1)(c+1)
+// r(c-1)           rc          r(c+1)
+// (r+1)(c-1)       (r+1)c      (r+1)(c+1)
+int Board::floodReveal(int row, int col, CellRect &changed) {
+    if (visited.size() != (cells.size() + 63) / 64) {
+        visited.assign((cells.size() + 63) / 64, 0);
+    }
+    if (fillQueue.empty()) {
+        fillQueue.resize(INITIAL_FILL_QUEUE);
+    }
+    int revealed = 0;
+    changed = CellRect{row, col, row, col};
+    // head and tail run freely and are masked on use; tail - head is the number of queued cells
+    std::size_t head = 0, tail = 0, mask = fillQueue.size() - 1;
+    int *ring = fillQueue.data();
+    int start = index(row, col);
+    testAndSetVisited(start);
+    ring[tail++ & mask] = start;    //Pushing the current tile
+    while (head != tail) {
+        int i = ring[head++ & mask];
+        if (state(i) == TileState::Revealed || isMine(i)) {
+            continue;
+        }
+        if (state(i) != TileState::Flagged) {
+            setState(i, TileState::Revealed);
+            revealed++;
+        }
+        int r = i / numCols, c = i % numCols;
+        changed.top = std::min(changed.top, r);
+        changed.bottom = std::max(changed.bottom, r);
+        changed.left = std::min(changed.left, c);
+        changed.right = std::max(changed.right, c);
+        if (adjacentMines(i) != 0) {
+            continue;
+        }
+        for (int nr = r - 1; nr <= r + 1; nr++) {
+            for (int nc = c - 1; nc <= c + 1; nc++) {
+                if (!inBounds(nr, nc)) {
+                    continue;
+                }
+                int n = index(nr, nc);
+                // Skip open tiles, mines and anything already queued; none of them can change the result.
+                // The visited bit is only set for cells that get queued, so the cleanup below covers all of them.
+                if (state(n) == TileState::Revealed || isMine(n) || testAndSetVisited(n)) {
+                    continue;
+                }
+                if (tail - head == mask + 1) {
+                    // The ring now starts at 0; head and tail stay locals so they can live in registers
+                    tail = growFillQueue(head, tail);
+                    head = 0;
+                    mask = fillQueue.size() - 1;
+                    ring = fillQueue.data();
+                }
+                ring[tail++ & mask] = n;      //Pushing the neighbors of the current tile
+            }
+        }
+    }
+    // Every queued cell is popped and widens changed, so the bits this fill set all lie between
+    // changed's first and last cell; only those words are cleared instead of the whole bitmap
+    std::fill(visited.begin() + (index(changed.top, changed.left) >> 6),
+              visited.begin() + (index(changed.bottom, changed.right) >> 6) + 1, std::uint64_t(0));
+    return revealed;
+}
+
+std::size_t Board::growFillQueue(std::size_t head, std::size_t tail) {
+    // Unroll the full ring into one twice the size
+    std::vector<int> grown(fillQueue.size() * 2);
+    const std::size_t mask = fillQueue.size() - 1;
+    for (std::size_t k = head; k != tail; k++) {
+        grown[k - head] = fillQueue[k & mask];
+    }
+    fillQueue.swap(grown);
+    return tail - head;
+}
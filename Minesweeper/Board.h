@@ -0,0 +1,124 @@
+#ifndef MINESWEEPER_BOARD_H
+#define MINESWEEPER_BOARD_H
+
+#include <cstdint>
+#include <vector>
+
+enum class TileState {
+    Hidden,
+    Flagged,
+    Revealed
+};
+
+// Inclusive rectangle of cells, used to report which tiles a move may have changed
+struct CellRect {
+    int top;
+    int left;
+    int bottom;
+    int right;
+};
+
+/**
+ * The game grid stored as one contiguous row-major buffer.
+ * Every cell is packed into a single byte:
+ *   bits 0-3   number of adjacent mines (0..8)
+ *   bit  4     mine bit
+ *   bits 5-6   TileState (Hidden/Flagged/Revealed)
+ */
+class Board {
+public:
+    Board() = default;
+
+    Board(int numRows, int numCols) {
+        reset(numRows, numCols);
+    }
+
+    // Resize the grid (if needed) and clear every cell to a hidden, mine-free tile
+    void reset(int numRows, int numCols);
+
+    int rows() const { return numRows; }
+
+    int cols() const { return numCols; }
+
+    int size() const { return numRows * numCols; }
+
+    int index(int row, int col) const { return row * numCols + col; }
+
+    bool inBounds(int row, int col) const { return row >= 0 && row < numRows && col >= 0 && col < numCols; }
+
+    bool isMine(int i) const { return (cells[i] & MINE_BIT) != 0; }
+
+    bool isMine(int row, int col) const { return isMine(index(row, col)); }
+
+    int adjacentMines(int i) const { return cells[i] & COUNT_MASK; }
+
+    int adjacentMines(int row, int col) const { return adjacentMines(index(row, col)); }
+
+    TileState state(int i) const { return static_cast<TileState>((cells[i] & STATE_MASK) >> STATE_SHIFT); }
+
+    TileState state(int row, int col) const { return state(index(row, col)); }
+
+    void setState(int i, TileState s) {
+        cells[i] = static_cast<std::uint8_t>((cells[i] & ~STATE_MASK) | (static_cast<int>(s) << STATE_SHIFT));
+    }
+
+    void setState(int row, int col, TileState s) { setState(index(row, col), s); }
+
+    // Generation stage 1: set the mine bit only. Counts are stale until computeAdjacency() runs.
+    void setMine(int i) { cells[i] |= MINE_BIT; }
+
+    void setMine(int row, int col) { setMine(index(row, col)); }
+
+    void clearMine(int i) { cells[i] &= static_cast<std::uint8_t>(~MINE_BIT); }
+
+    // Generation stage 2: recompute every cell's adjacent-mine count from the mine bits in one stencil pass
+    void computeAdjacency() { computeAdjacency(0, numRows - 1); }
+
+    // Same, limited to rows firstRow..lastRow, e.g. after moving a few mines
+    void computeAdjacency(int firstRow, int lastRow);
+
+    // Breadth-first reveal of the opening around (row, col). Returns the number of tiles newly revealed
+    // and sets changed to the bounds of the tiles it touched.
+    // Uses the board's own scratch buffers, built on the first call, so later clicks do not allocate.
+    int floodReveal(int row, int col, CellRect &changed);
+
+    // Trades flood fill scratch with a board of the same size: a pooled board hands its (empty) scratch
+    // to the board it replaces, and the board being played keeps the one it already built
+    void swapScratch(Board &other) {
+        visited.swap(other.visited);
+        fillQueue.swap(other.fillQueue);
+    }
+
+    // Raw packed bytes, e.g. for debugging or serialising a layout
+    const std::vector<std::uint8_t> &data() const { return cells; }
+
+    static const std::uint8_t COUNT_MASK = 0x0F;
+    static const std::uint8_t MINE_BIT = 0x10;
+    static const std::uint8_t STATE_MASK = 0x60;
+    static const int STATE_SHIFT = 5;
+
+private:
+    int numRows = 0;
+    int numCols = 0;
+    std::vector<std::uint8_t> cells;
+    std::vector<std::uint8_t> stencilScratch;
+    // Flood fill scratch, built by the first floodReveal so boards that are never clicked stay at a byte per cell.
+    // visited holds a bit per cell; fillQueue is a ring of a power-of-two size that only holds the fill's
+    // frontier, and doubles when the frontier outgrows it.
+    std::vector<std::uint64_t> visited;
+    std::vector<int> fillQueue;
+
+    // Doubles the fill ring when the frontier fills it, moving the queued cells to its start in order.
+    // Returns the new tail.
+    std::size_t growFillQueue(std::size_t head, std::size_t tail);
+
+    bool testAndSetVisited(int i) {
+        std::uint64_t bit = std::uint64_t(1) << (i & 63);
+        std::uint64_t &word = visited[i >> 6];
+        bool seen = (word & bit) != 0;
+        word |= bit;
+        return seen;
+    }
+};
+
+#endif //MINESWEEPER_BOARD_H
@@ -0,0 +1,112 @@
+#include "BoardLod.h"
+#include <algorithm>
+#include "Atlas.h"
+#include "BoardRenderer.h"
+
+const unsigned BoardLod::MAX_SIZE;
+
+namespace {
+    // Colour of each tile look, indexed by Atlas::Id; numbers are tinted like their digits
+    const sf::Uint8 PALETTE[Atlas::DebugMineFlag + 1][3] = {
+            {160, 160, 160},    // TileHidden
+            {222, 222, 222},    // TileRevealed
+            {190, 200, 245},    // Number1
+            {190, 230, 190},    // Number2
+            {245, 190, 190},    // Number3
+            {175, 175, 225},    // Number4
+            {225, 175, 175},    // Number5
+            {175, 220, 220},    // Number6
+            {140, 140, 140},    // Number7
+            {195, 195, 195},    // Number8
+            {20,  20,  20},     // Mine
+            {225, 40,  40},     // Flag
+            {95,  60,  60},     // DebugMine
+            {150, 30,  30},     // DebugMineFlag
+    };
+}
+
+BoardLod::BoardLod(int tileSize) : tileSize(tileSize) {
+}
+
+void BoardLod::update(const GameBoard &board, bool paused, bool debug, const std::vector<CellRect> &changes) {
+    if (board.rows() != numRows || board.cols() != numCols || paused != lastPaused || debug != lastDebug) {
+        numRows = board.rows();
+        numCols = board.cols();
+        lastPaused = paused;
+        lastDebug = debug;
+        const int maxSize = (int) std::min(MAX_SIZE, sf::Texture::getMaximumSize());
+        cellsPerPixel = 1;
+        while ((numCols + cellsPerPixel - 1) / cellsPerPixel > maxSize ||
+               (numRows + cellsPerPixel - 1) / cellsPerPixel > maxSize) {
+            cellsPerPixel *= 2;
+        }
+        const unsigned newWidth = (unsigned) ((numCols + cellsPerPixel - 1) / cellsPerPixel);
+        const unsigned newHeight = (unsigned) ((numRows + cellsPerPixel - 1) / cellsPerPixel);
+        if (newWidth != width || newHeight != height) {
+            width = newWidth;
+            height = newHeight;
+            // Alpha is always opaque; only the colour channels are written afterwards
+            pixels.assign((std::size_t) width * height * 4, 255);
+            lodTexture.create(width, height);
+        }
+        redraw(board, CellRect{0, 0, numRows - 1, numCols - 1}, paused, debug);
+        return;
+    }
+    for (const CellRect &rect : changes) {
+        redraw(board, rect, paused, debug);
+    }
+}
+
+void BoardLod::redraw(const GameBoard &board, const CellRect &rect, bool paused, bool debug) {
+    const int s = cellsPerPixel;
+    const int firstY = std::max(rect.top, 0) / s;
+    const int lastY = std::min(rect.bottom, numRows - 1) / s;
+    const int firstX = std::max(rect.left, 0) / s;
+    const int lastX = std::min(rect.right, numCols - 1) / s;
+    if (firstY > lastY || firstX > lastX) {
+        return;
+    }
+    if (s == 1) {
+        // One cell per pixel: copy colours straight from the palette
+        for (int y = firstY; y <= lastY; y++) {
+            sf::Uint8 *pixel = &pixels[((std::size_t) y * width + firstX) * 4];
+            int cell = board.index(y, firstX);
+            for (int x = firstX; x <= lastX; x++, cell++, pixel += 4) {
+                const sf::Uint8 *colour = PALETTE[BoardRenderer::slotFor(board, cell, paused, debug)];
+                pixel[0] = colour[0];
+                pixel[1] = colour[1];
+                pixel[2] = colour[2];
+            }
+        }
+    }
+    for (int y = firstY; s > 1 && y <= lastY; y++) {
+        for (int x = firstX; x <= lastX; x++) {
+            // Average of the cells under the pixel
+            unsigned sum[3] = {0, 0, 0};
+            int count = 0;
+            for (int i = y * s; i < std::min((y + 1) * s, numRows); i++) {
+                for (int j = x * s; j < std::min((x + 1) * s, numCols); j++) {
+                    const sf::Uint8 *colour = PALETTE[BoardRenderer::slotFor(board, board.index(i, j), paused, debug)];
+                    sum[0] += colour[0];
+                    sum[1] += colour[1];
+                    sum[2] += colour[2];
+                    count++;
+                }
+            }
+            sf::Uint8 *pixel = &pixels[((std::size_t) y * width + x) * 4];
+            pixel[0] = (sf::Uint8) (sum[0] / count);
+            pixel[1] = (sf::Uint8) (sum[1] / count);
+            pixel[2] = (sf::Uint8) (sum[2] / count);
+        }
+    }
+    // Whole rows are contiguous in the image, so the band of rows goes up in one call
+    lodTexture.update(&pixels[(std::size_t) firstY * width * 4], width, (unsigned) (lastY - firstY + 1), 0,
+                      (unsigned) firstY);
+}
+
+void BoardLod::draw(sf::RenderTarget &target, sf::RenderStates states) const {
+    sf::Sprite sprite(lodTexture);
+    const float pixelSize = (float) (cellsPerPixel * tileSize);
+    sprite.setScale(pixelSize, pixelSize);
+    target.draw(sprite, states);
+}
@@ -0,0 +1,52 @@
+#ifndef MINESWEEPER_BOARDLOD_H
+#define MINESWEEPER_BOARDLOD_H
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "GameBoard.h"
+
+/**
+ * Low-detail picture of the whole board: one RGBA pixel per cell, coloured by the tile's look.
+ * Boards wider or taller than the largest usable texture are downsampled by a power of two,
+ * each pixel averaging the cells it covers. Only the pixels under changed cells are recomputed,
+ * and only their rows are uploaded, so keeping it current costs about as much as the moves themselves.
+ * Drawn at world scale it stands in for the tiles when the camera is zoomed far out,
+ * which keeps the frame a single textured quad at any zoom; it also backs the HUD minimap.
+ */
+class BoardLod : public sf::Drawable {
+public:
+    // Largest side of the image; bigger boards are downsampled to fit
+    static const unsigned MAX_SIZE = 4096;
+
+    // tileSize is the size of a cell in world pixels
+    explicit BoardLod(int tileSize);
+
+    // Recomputes the pixels under the changed cells (see Game::changes).
+    // Everything is redrawn when the board size, pause state or debug mode changes.
+    void update(const GameBoard &board, bool paused, bool debug, const std::vector<CellRect> &changes);
+
+    const sf::Texture &texture() const { return lodTexture; }
+
+    // Board cells per side covered by one pixel
+    int scale() const { return cellsPerPixel; }
+
+private:
+    const int tileSize;
+    int numRows = 0;
+    int numCols = 0;
+    int cellsPerPixel = 1;
+    bool lastPaused = false;
+    bool lastDebug = false;
+    // Image size in pixels and its RGBA bytes, row-major
+    unsigned width = 0;
+    unsigned height = 0;
+    std::vector<sf::Uint8> pixels;
+    sf::Texture lodTexture;
+
+    // Recomputes and uploads the pixels covering the cells in rect
+    void redraw(const GameBoard &board, const CellRect &rect, bool paused, bool debug);
+
+    void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+};
+
+#endif //MINESWEEPER_BOARDLOD_H
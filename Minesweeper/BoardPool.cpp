@@ -0,0 +1,58 @@
+#include "BoardPool.h"
+#include <utility>
+#include "Rng.h"
+
+BoardPool::BoardPool(std::size_t capacity, Generator generator)
+        : capacity(capacity), generate(std::move(generator)) {
+    worker = std::thread(&BoardPool::run, this);
+}
+
+BoardPool::~BoardPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+std::uint64_t BoardPool::swapInto(GameBoard &board) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (ready.empty()) {
+        lock.unlock();
+        std::uint64_t seed = randomSeed();
+        generate(board, seed);
+        return seed;
+    }
+    Entry entry = std::move(ready.front());
+    ready.pop_front();
+    std::swap(board, entry.board);
+    // Only the cells change hands: the caller keeps its flood fill scratch, and the old board goes back
+    // to the pool without it, so pooled boards cost their cells alone
+    board.swapScratch(entry.board);
+    spare.push_back(std::move(entry.board));
+    lock.unlock();
+    wake.notify_one();
+    return entry.seed;
+}
+
+void BoardPool::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || ready.size() < capacity; });
+        if (stopping) {
+            return;
+        }
+        Entry entry;
+        if (!spare.empty()) {
+            entry.board = std::move(spare.back());
+            spare.pop_back();
+        }
+        // Generate without holding the lock so the render thread is never blocked on it
+        lock.unlock();
+        entry.seed = randomSeed();
+        generate(entry.board, entry.seed);
+        lock.lock();
+        ready.push_back(std::move(entry));
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef MINESWEEPER_BOARDPOOL_H
+#define MINESWEEPER_BOARDPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "GameBoard.h"
+
+/**
+ * Keeps a bounded queue of ready-made boards for one configuration, filled by a worker thread,
+ * so restarting a game does not run generation on the render thread.
+ * Boards are handed over by swapping storage with the caller's board, and the caller's old
+ * storage is recycled for the next generation, so steady-state restarts do not allocate.
+ */
+class BoardPool {
+public:
+    // Resets the given board to the pool's dimensions and lays out mines from the seed
+    typedef std::function<void(GameBoard &, std::uint64_t)> Generator;
+
+    BoardPool(std::size_t capacity, Generator generator);
+
+    ~BoardPool();
+
+    BoardPool(const BoardPool &) = delete;
+
+    BoardPool &operator=(const BoardPool &) = delete;
+
+    // Swaps a ready board into `board` and returns its seed.
+    // If the worker has not caught up yet, generates one on the calling thread instead of waiting.
+    std::uint64_t swapInto(GameBoard &board);
+
+private:
+    struct Entry {
+        GameBoard board;
+        std::uint64_t seed;
+    };
+
+    const std::size_t capacity;
+    Generator generate;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Entry> ready;
+    // Storage handed back by swapInto, reused for the next board
+    std::vector<GameBoard> spare;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif //MINESWEEPER_BOARDPOOL_H
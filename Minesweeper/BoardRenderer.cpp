@@ -0,0 +1,180 @@
+#include "BoardRenderer.h"
+#include <algorithm>
+#include <cmath>
+
+const int BoardRenderer::TILE_SIZE;
+
+const int BoardRenderer::CHUNK_SIZE;
+
+const std::size_t BoardRenderer::MAX_CACHED_CHUNKS;
+
+const std::uint8_t BoardRenderer::UNSET;
+
+BoardRenderer::BoardRenderer(const Atlas &atlas) : atlas(atlas) {
+}
+
+Atlas::Id BoardRenderer::slotFor(const GameBoard &board, int cell, bool paused, bool debug) {
+    if (paused) {
+        return Atlas::TileRevealed;
+    }
+    if (board.state(cell) == TileState::Revealed) {
+        if (board.isMine(cell)) {
+            return Atlas::Mine;
+        }
+        int count = board.adjacentMines(cell);
+        return count > 0 ? static_cast<Atlas::Id>(Atlas::Number1 + count - 1) : Atlas::TileRevealed;
+    }
+    //If the game is in debug mode then draw the mines, too.
+    bool showMine = debug && board.isMine(cell);
+    if (board.state(cell) == TileState::Flagged) {
+        return showMine ? Atlas::DebugMineFlag : Atlas::Flag;
+    }
+    return showMine ? Atlas::DebugMine : Atlas::TileHidden;
+}
+
+BoardRenderer::Chunk &BoardRenderer::chunkAt(int chunkRow, int chunkCol) {
+    std::unique_ptr<Chunk> &slot = chunks[chunkRow * chunkCols + chunkCol];
+    if (slot) {
+        return *slot;
+    }
+    slot.reset(new Chunk);
+    Chunk &chunk = *slot;
+    chunk.top = chunkRow * CHUNK_SIZE;
+    chunk.left = chunkCol * CHUNK_SIZE;
+    chunk.rows = std::min(CHUNK_SIZE, numRows - chunk.top);
+    chunk.cols = std::min(CHUNK_SIZE, numCols - chunk.left);
+    chunk.vertices.resize(static_cast<std::size_t>(chunk.rows) * chunk.cols * 4);
+    chunk.slots.assign(static_cast<std::size_t>(chunk.rows) * chunk.cols, UNSET);
+    // Positions are relative to the chunk's corner and never change
+    const float size = TILE_SIZE;
+    for (int i = 0; i < chunk.rows; i++) {
+        for (int j = 0; j < chunk.cols; j++) {
+            sf::Vertex *quad = &chunk.vertices[(static_cast<std::size_t>(i) * chunk.cols + j) * 4];
+            quad[0].position = sf::Vector2f((float) j * size, (float) i * size);
+            quad[1].position = sf::Vector2f((float) (j + 1) * size, (float) i * size);
+            quad[2].position = sf::Vector2f((float) (j + 1) * size, (float) (i + 1) * size);
+            quad[3].position = sf::Vector2f((float) j * size, (float) (i + 1) * size);
+        }
+    }
+    if (sf::VertexBuffer::isAvailable()) {
+        chunk.hasBuffer = chunk.buffer.create(chunk.vertices.size());
+    }
+    return chunk;
+}
+
+bool BoardRenderer::refresh(Chunk &chunk, const GameBoard &board, bool paused, bool debug) {
+    // The changed quads are uploaded as one span, from the first changed cell to the last
+    int first = -1, last = -1;
+    for (int i = 0; i < chunk.rows; i++) {
+        for (int j = 0; j < chunk.cols; j++) {
+            const int local = i * chunk.cols + j;
+            const Atlas::Id slot = slotFor(board, board.index(chunk.top + i, chunk.left + j), paused, debug);
+            if (chunk.slots[local] == slot) {
+                continue;
+            }
+            chunk.slots[local] = slot;
+            const sf::IntRect &rect = atlas.rect(slot);
+            const float texLeft = (float) rect.left;
+            const float texTop = (float) rect.top;
+            const float texRight = (float) (rect.left + rect.width);
+            const float texBottom = (float) (rect.top + rect.height);
+            sf::Vertex *quad = &chunk.vertices[static_cast<std::size_t>(local) * 4];
+            quad[0].texCoords = sf::Vector2f(texLeft, texTop);
+            quad[1].texCoords = sf::Vector2f(texRight, texTop);
+            quad[2].texCoords = sf::Vector2f(texRight, texBottom);
+            quad[3].texCoords = sf::Vector2f(texLeft, texBottom);
+            if (first < 0) {
+                first = local;
+            }
+            last = local;
+        }
+    }
+    chunk.generation = generation;
+    if (first < 0) {
+        return false;
+    }
+    if (chunk.hasBuffer) {
+        const std::size_t offset = static_cast<std::size_t>(first) * 4;
+        chunk.buffer.update(&chunk.vertices[offset], static_cast<std::size_t>(last - first + 1) * 4,
+                            (unsigned) offset);
+    }
+    return true;
+}
+
+void BoardRenderer::evict() {
+    while (chunks.size() > MAX_CACHED_CHUNKS) {
+        auto oldest = chunks.end();
+        for (auto it = chunks.begin(); it != chunks.end(); ++it) {
+            if (it->second->lastUsed != updates &&
+                (oldest == chunks.end() || it->second->lastUsed < oldest->second->lastUsed)) {
+                oldest = it;
+            }
+        }
+        // Everything left is in view
+        if (oldest == chunks.end()) {
+            return;
+        }
+        chunks.erase(oldest);
+    }
+}
+
+void BoardRenderer::invalidate(const std::vector<CellRect> &changes) {
+    for (const CellRect &rect : changes) {
+        for (auto &entry : chunks) {
+            Chunk &chunk = *entry.second;
+            if (rect.top < chunk.top + chunk.rows && rect.bottom >= chunk.top &&
+                rect.left < chunk.left + chunk.cols && rect.right >= chunk.left) {
+                chunk.generation = 0;
+            }
+        }
+    }
+}
+
+bool BoardRenderer::update(const GameBoard &board, bool paused, bool debug, const sf::FloatRect &area) {
+    if (board.rows() != numRows || board.cols() != numCols) {
+        numRows = board.rows();
+        numCols = board.cols();
+        chunkCols = (numCols + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        chunks.clear();
+    }
+    if (paused != lastPaused || debug != lastDebug) {
+        generation++;
+        lastPaused = paused;
+        lastDebug = debug;
+    }
+    updates++;
+    visible.clear();
+    rebuilt = 0;
+    // Chunks the camera can see, clamped to the board
+    const float chunkPixels = (float) (CHUNK_SIZE * TILE_SIZE);
+    const int chunkRows = (numRows + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    const int firstRow = std::max(0, (int) std::floor(area.top / chunkPixels));
+    const int lastRow = std::min(chunkRows - 1, (int) std::floor((area.top + area.height) / chunkPixels));
+    const int firstCol = std::max(0, (int) std::floor(area.left / chunkPixels));
+    const int lastCol = std::min(chunkCols - 1, (int) std::floor((area.left + area.width) / chunkPixels));
+    for (int i = firstRow; i <= lastRow; i++) {
+        for (int j = firstCol; j <= lastCol; j++) {
+            Chunk &chunk = chunkAt(i, j);
+            if (chunk.generation != generation && refresh(chunk, board, paused, debug)) {
+                rebuilt++;
+            }
+            chunk.lastUsed = updates;
+            visible.push_back(&chunk);
+        }
+    }
+    evict();
+    return rebuilt > 0;
+}
+
+void BoardRenderer::draw(sf::RenderTarget &target, sf::RenderStates states) const {
+    states.texture = &atlas.texture();
+    for (const Chunk *chunk : visible) {
+        sf::RenderStates chunkStates(states);
+        chunkStates.transform.translate((float) (chunk->left * TILE_SIZE), (float) (chunk->top * TILE_SIZE));
+        if (chunk->hasBuffer) {
+            target.draw(chunk->buffer, chunkStates);
+        } else {
+            target.draw(chunk->vertices.data(), chunk->vertices.size(), sf::Quads, chunkStates);
+        }
+    }
+}
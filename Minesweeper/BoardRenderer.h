@@ -0,0 +1,93 @@
+#ifndef MINESWEEPER_BOARDRENDERER_H
+#define MINESWEEPER_BOARDRENDERER_H
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Atlas.h"
+#include "GameBoard.h"
+
+/**
+ * Draws the part of the tile grid the camera can see, as quads over the shared Atlas.
+ * The grid is split into CHUNK_SIZE x CHUNK_SIZE chunks, each with its own pre-baked sf::VertexBuffer,
+ * so a frame is one draw call per visible chunk and zooming or scrolling reuses the buffers as they are.
+ * Every look a tile can have (including flag-over-mine in debug mode) is a pre-composed atlas entry,
+ * so each cell is exactly one quad. Only chunks overlapping a changed area are re-checked: they compare each
+ * cell's look with what they hold and upload only the span of quads that changed.
+ * A bounded number of chunks is kept, dropping the least recently drawn.
+ */
+class BoardRenderer : public sf::Drawable {
+public:
+    static const int TILE_SIZE = 32;
+    static const int CHUNK_SIZE = 64;
+    static const std::size_t MAX_CACHED_CHUNKS = 128;
+
+    // The atlas must outlive the renderer
+    explicit BoardRenderer(const Atlas &atlas);
+
+    // Marks the cached chunks overlapping the changed cells (see Game::changes) for re-checking
+    void invalidate(const std::vector<CellRect> &changes);
+
+    // Selects the chunks covering area (in world pixels) and brings them in line with the board.
+    // Returns true if any quad was rewritten.
+    bool update(const GameBoard &board, bool paused, bool debug, const sf::FloatRect &area);
+
+    // Statistics of the last update
+    std::size_t visibleChunks() const { return visible.size(); }
+
+    std::size_t rebuiltChunks() const { return rebuilt; }
+
+    std::size_t cachedChunks() const { return chunks.size(); }
+
+    // The atlas entry a cell is drawn with
+    static Atlas::Id slotFor(const GameBoard &board, int cell, bool paused, bool debug);
+
+private:
+    // Marks a cell whose quad has not been written yet
+    static const std::uint8_t UNSET = 0xFF;
+
+    struct Chunk {
+        // First tile of the chunk and its size in tiles (edge chunks can be smaller)
+        int top = 0;
+        int left = 0;
+        int rows = 0;
+        int cols = 0;
+        // Quads and the Atlas::Id written for each cell, row-major within the chunk
+        std::vector<sf::Vertex> vertices;
+        std::vector<std::uint8_t> slots;
+        sf::VertexBuffer buffer{sf::Quads, sf::VertexBuffer::Dynamic};
+        bool hasBuffer = false;
+        // Generation the cells were last compared at (0 when invalidated), and the update that last drew the chunk
+        unsigned long long generation = 0;
+        unsigned long long lastUsed = 0;
+    };
+
+    const Atlas &atlas;
+    int numRows = 0;
+    int numCols = 0;
+    int chunkCols = 0;
+    bool lastPaused = false;
+    bool lastDebug = false;
+    // Bumped when every cell's look may have changed (pause, debug); chunks from an older generation get re-checked
+    unsigned long long generation = 1;
+    unsigned long long updates = 0;
+    std::unordered_map<int, std::unique_ptr<Chunk>> chunks;
+    std::vector<const Chunk *> visible;
+    std::size_t rebuilt = 0;
+
+    Chunk &chunkAt(int chunkRow, int chunkCol);
+
+    // Rewrites the quads whose look changed and uploads them; returns true if any did
+    bool refresh(Chunk &chunk, const GameBoard &board, bool paused, bool debug);
+
+    // Drops the least recently drawn chunks that are out of view until at most MAX_CACHED_CHUNKS remain
+    void evict();
+
+    void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+};
+
+#endif //MINESWEEPER_BOARDRENDERER_H
@@ -0,0 +1,71 @@
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+
+constexpr float Camera::MIN_ZOOM;
+
+Camera::Camera(sf::Vector2f boardSize, sf::Vector2u windowSize, sf::FloatRect viewport, float maxZoom)
+        : board(boardSize), screen(viewport), maxZoomLevel(std::max(maxZoom, 1.0f)) {
+    boardView.setViewport(sf::FloatRect(viewport.left / (float) windowSize.x, viewport.top / (float) windowSize.y,
+                                        viewport.width / (float) windowSize.x,
+                                        viewport.height / (float) windowSize.y));
+    reset();
+}
+
+sf::FloatRect Camera::visibleArea() const {
+    return sf::FloatRect(origin.x, origin.y, screen.width * zoomLevel, screen.height * zoomLevel);
+}
+
+bool Camera::inViewport(sf::Vector2i pixel) const {
+    return screen.contains((float) pixel.x, (float) pixel.y);
+}
+
+sf::Vector2f Camera::toWorld(sf::Vector2i pixel) const {
+    return sf::Vector2f(origin.x + ((float) pixel.x - screen.left) * zoomLevel,
+                        origin.y + ((float) pixel.y - screen.top) * zoomLevel);
+}
+
+void Camera::pan(sf::Vector2f screenDelta) {
+    origin.x += screenDelta.x * zoomLevel;
+    origin.y += screenDelta.y * zoomLevel;
+    apply();
+}
+
+void Camera::centerOn(sf::Vector2f world) {
+    origin.x = world.x - screen.width * zoomLevel / 2.0f;
+    origin.y = world.y - screen.height * zoomLevel / 2.0f;
+    apply();
+}
+
+void Camera::zoomAt(sf::Vector2i pixel, float factor) {
+    const sf::Vector2f anchor = toWorld(pixel);
+    zoomLevel = std::min(std::max(zoomLevel * factor, MIN_ZOOM), maxZoomLevel);
+    // Zooming in and out by the same steps should land exactly on 1:1 again
+    if (std::fabs(zoomLevel - 1.0f) < 1e-3f) {
+        zoomLevel = 1.0f;
+    }
+    // Solve for the origin that puts the anchor back under the same pixel
+    origin.x = anchor.x - ((float) pixel.x - screen.left) * zoomLevel;
+    origin.y = anchor.y - ((float) pixel.y - screen.top) * zoomLevel;
+    apply();
+}
+
+void Camera::reset() {
+    zoomLevel = 1.0f;
+    origin = sf::Vector2f(0.0f, 0.0f);
+    apply();
+}
+
+void Camera::apply() {
+    const sf::Vector2f size(screen.width * zoomLevel, screen.height * zoomLevel);
+    // Along each axis: centre the board if it is smaller than the view, otherwise stay within its edges
+    origin.x = size.x >= board.x ? (board.x - size.x) / 2.0f : std::min(std::max(origin.x, 0.0f), board.x - size.x);
+    origin.y = size.y >= board.y ? (board.y - size.y) / 2.0f : std::min(std::max(origin.y, 0.0f), board.y - size.y);
+    // At 1:1 a whole-pixel origin keeps the tiles crisp
+    if (zoomLevel == 1.0f) {
+        origin.x = std::floor(origin.x);
+        origin.y = std::floor(origin.y);
+    }
+    boardView.setSize(size);
+    boardView.setCenter(origin.x + size.x / 2.0f, origin.y + size.y / 2.0f);
+}
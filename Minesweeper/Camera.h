@@ -0,0 +1,58 @@
+#ifndef MINESWEEPER_CAMERA_H
+#define MINESWEEPER_CAMERA_H
+
+#include <SFML/Graphics.hpp>
+
+/**
+ * Pans and zooms an sf::View over the board, which is drawn in world coordinates of 32 px per tile.
+ * The view is shown in a fixed viewport (the window above the HUD bar), and is kept over the board:
+ * it can't scroll past an edge, and a board smaller than the view is centred.
+ * Zoom is the number of world pixels per screen pixel, so 1 is the original look and larger values zoom out.
+ */
+class Camera {
+public:
+    static constexpr float MIN_ZOOM = 0.25f;
+
+    // boardSize is in world pixels, viewport is the screen area in pixels the board is drawn into.
+    // maxZoom caps how far the camera may zoom out (it is never forced below 1).
+    Camera(sf::Vector2f boardSize, sf::Vector2u windowSize, sf::FloatRect viewport, float maxZoom);
+
+    const sf::View &view() const { return boardView; }
+
+    float zoom() const { return zoomLevel; }
+
+    // World rectangle currently on screen
+    sf::FloatRect visibleArea() const;
+
+    // Whether a window pixel falls inside the board's viewport
+    bool inViewport(sf::Vector2i pixel) const;
+
+    // World position under a window pixel
+    sf::Vector2f toWorld(sf::Vector2i pixel) const;
+
+    // Scrolls by a distance in screen pixels; positive moves the view right/down
+    void pan(sf::Vector2f screenDelta);
+
+    // Scrolls so the world point is in the middle of the view (as far as the board edges allow)
+    void centerOn(sf::Vector2f world);
+
+    // Multiplies the zoom by factor, keeping the world point under pixel fixed
+    void zoomAt(sf::Vector2i pixel, float factor);
+
+    // Back to zoom 1 with the board's top-left corner in the top-left of the viewport
+    void reset();
+
+private:
+    sf::Vector2f board;
+    sf::FloatRect screen;
+    float maxZoomLevel;
+    float zoomLevel = 1.0f;
+    // World position of the viewport's top-left corner
+    sf::Vector2f origin;
+    sf::View boardView;
+
+    // Keeps the view over the board and pushes the result into boardView
+    void apply();
+};
+
+#endif //MINESWEEPER_CAMERA_H
@@ -0,0 +1,39 @@
+# Writes a C++ source defining findEmbeddedAsset() (see EmbeddedAssets.h) over the given asset files.
+# Usage: cmake -DASSET_DIR=<dir> -DASSETS=<name|name|...> -DOUTPUT=<file.cpp> -P EmbedAssets.cmake
+# ASSETS are paths relative to ASSET_DIR, separated by '|'.
+
+string(REPLACE "|" ";" ASSETS "${ASSETS}")
+
+set(arrays "")
+set(table "")
+set(index 0)
+foreach (name IN LISTS ASSETS)
+    file(READ "${ASSET_DIR}/${name}" hex HEX)
+    file(SIZE "${ASSET_DIR}/${name}" size)
+    # 32 bytes per line, then every byte as 0x.., and a trailing zero so text assets are terminated
+    string(REGEX REPLACE "([0-9a-f]{64})" "\\1\n" hex "${hex}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," hex "${hex}")
+    string(APPEND arrays "// ${name}\nconst unsigned char asset${index}[] = {\n${hex}0x00};\n\n")
+    string(APPEND table "        {\"${name}\", asset${index}, ${size}},\n")
+    math(EXPR index "${index} + 1")
+endforeach ()
+
+set(source "// Generated by EmbedAssets.cmake from ${ASSET_DIR}; do not edit.
+#include \"EmbeddedAssets.h\"
+
+namespace {
+${arrays}const EmbeddedAsset ASSETS[] = {
+${table}};
+}
+
+const EmbeddedAsset *findEmbeddedAsset(const std::string &name) {
+    for (const EmbeddedAsset &asset : ASSETS) {
+        if (name == asset.name) {
+            return &asset;
+        }
+    }
+    return nullptr;
+}
+")
+
+file(WRITE "${OUTPUT}" "${source}")
@@ -0,0 +1,22 @@
+#ifndef MINESWEEPER_EMBEDDEDASSETS_H
+#define MINESWEEPER_EMBEDDEDASSETS_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * Asset files compiled into the binary by the build (see EmbedAssets.cmake), so the game needs nothing
+ * from the working directory to start. Names are paths relative to the asset directory,
+ * e.g. "font.ttf" or "images/mine.png".
+ */
+struct EmbeddedAsset {
+    const char *name;
+    const unsigned char *data;
+    // Not counting the zero byte that follows the data
+    std::size_t size;
+};
+
+// The embedded copy of an asset, or nullptr if there is none
+const EmbeddedAsset *findEmbeddedAsset(const std::string &name);
+
+#endif //MINESWEEPER_EMBEDDEDASSETS_H
@@ -0,0 +1,126 @@
+#include "Game.h"
+#include <algorithm>
+#include "BoardPool.h"
+#include "Generator.h"
+
+Game::Game(int numRows, int numCols, int mineCount, bool safeOpening)
+        : numRows(numRows), numCols(numCols), mineCount(mineCount), safeOpening(safeOpening) {
+}
+
+void Game::start(std::uint64_t seed) {
+    boardSeed = seed;
+    initGame(gameBoard, numRows, numCols, mineCount, seed);
+    resetCounters();
+}
+
+void Game::start(BoardPool &pool) {
+    boardSeed = pool.swapInto(gameBoard);
+    resetCounters();
+}
+
+void Game::markChanged(const CellRect &rect) {
+    // Past this many rectangles the consumers would do more work than redrawing everything
+    const std::size_t maxChanges = 256;
+    if (changeLog.size() >= maxChanges) {
+        markAllChanged();
+        return;
+    }
+    // Nothing to add once the whole board is marked
+    const CellRect &first = changeLog.empty() ? rect : changeLog.front();
+    if (first.top == 0 && first.left == 0 && first.bottom == gameBoard.rows() - 1 &&
+        first.right == gameBoard.cols() - 1 && !changeLog.empty()) {
+        return;
+    }
+    changeLog.push_back(rect);
+}
+
+void Game::markAllChanged() {
+    changeLog.assign(1, CellRect{0, 0, gameBoard.rows() - 1, gameBoard.cols() - 1});
+}
+
+void Game::resetCounters() {
+    markAllChanged();
+    gameState = GameState::InProgress;
+    firstClickDone = false;
+    mines = std::min(std::max(mineCount, 0), gameBoard.size());
+    flags = 0;
+    revealed = 0;
+}
+
+void Game::reveal(int row, int col) {
+    if (gameState != GameState::InProgress || !gameBoard.inBounds(row, col)) {
+        return;
+    }
+    // Only reveal tile if it is not flagged
+    if (gameBoard.state(row, col) == TileState::Flagged) {
+        return;
+    }
+    if (!firstClickDone) {
+        // Only the opening and the tiles around the few relocated mines change, not the whole board
+        std::vector<CellRect> moved;
+        mines = commitFirstClick(gameBoard, mineCount, boardSeed, row, col, safeOpening, moved);
+        firstClickDone = true;
+        for (const CellRect &rect : moved) {
+            markChanged(rect);
+        }
+    }
+    if (gameBoard.isMine(row, col)) {
+        lose();
+        return;
+    }
+    // Numbers reveal just themselves, empty tiles the whole opening around them
+    CellRect changed{};
+    revealed += gameBoard.floodReveal(row, col, changed);
+    markChanged(changed);
+    checkWin();
+}
+
+void Game::toggleFlag(int row, int col) {
+    if (gameState != GameState::InProgress || !gameBoard.inBounds(row, col)) {
+        return;
+    }
+    if (gameBoard.state(row, col) == TileState::Hidden) {
+        gameBoard.setState(row, col, TileState::Flagged);
+        flags++;
+    } else if (gameBoard.state(row, col) == TileState::Flagged) {
+        gameBoard.setState(row, col, TileState::Hidden);
+        flags--;
+    } else {
+        return;
+    }
+    markChanged(CellRect{row, col, row, col});
+}
+
+void Game::setPaused(bool paused) {
+    if (paused && gameState == GameState::InProgress) {
+        gameState = GameState::Paused;
+    } else if (!paused && gameState == GameState::Paused) {
+        gameState = GameState::InProgress;
+    }
+}
+
+void Game::lose() {
+    // Reveal all bomb tiles
+    for (int i = 0; i < gameBoard.size(); i++) {
+        if (gameBoard.isMine(i)) {
+            gameBoard.setState(i, TileState::Revealed);
+        }
+    }
+    markAllChanged();
+    gameState = GameState::Lose;
+}
+
+void Game::checkWin() {
+    if (revealed != gameBoard.size() - mines) {
+        return;
+    }
+    // Flag every mine so the counter ends at zero
+    for (int i = 0; i < gameBoard.size(); i++) {
+        if (gameBoard.isMine(i) && gameBoard.state(i) != TileState::Flagged) {
+            gameBoard.setState(i, TileState::Flagged);
+            flags++;
+        }
+    }
+    markAllChanged();
+    gameState = GameState::Win;
+}
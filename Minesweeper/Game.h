@@ -0,0 +1,90 @@
+#ifndef MINESWEEPER_GAME_H
+#define MINESWEEPER_GAME_H
+
+#include <cstdint>
+#include <vector>
+#include "GameBoard.h"
+
+class BoardPool;
+
+enum class GameState {
+    InProgress,
+    Win,
+    Lose,
+    Paused
+};
+
+/**
+ * One game of Minesweeper without any rendering: owns the board and applies reveal/flag moves,
+ * first-click safety, and the win/lose rules. The SFML front end and headless bots both drive this.
+ */
+class Game {
+public:
+    Game(int numRows, int numCols, int mineCount, bool safeOpening);
+
+    // Starts a new game with a board generated from the seed on the calling thread
+    void start(std::uint64_t seed);
+
+    // Starts a new game with a board taken from the pool
+    void start(BoardPool &pool);
+
+    // Left click: reveals the tile (or the whole opening around it). Ignored unless the game is in progress.
+    void reveal(int row, int col);
+
+    // Right click: toggles a flag on a hidden tile. Ignored unless the game is in progress.
+    void toggleFlag(int row, int col);
+
+    // Pauses an in-progress game or resumes a paused one
+    void setPaused(bool paused);
+
+    GameState state() const { return gameState; }
+
+    bool isOver() const { return gameState == GameState::Win || gameState == GameState::Lose; }
+
+    const GameBoard &board() const { return gameBoard; }
+
+    std::uint64_t seed() const { return boardSeed; }
+
+    // True once the first reveal has fixed the mine layout
+    bool layoutCommitted() const { return firstClickDone; }
+
+    // Value for the mine counter: mines minus flags placed (can go negative)
+    int minesRemaining() const { return mines - flags; }
+
+    int tilesRevealed() const { return revealed; }
+
+    // Cells whose look may have changed since the last clearChanges(), as possibly overlapping rectangles.
+    // Lets renderers update only what a move touched.
+    const std::vector<CellRect> &changes() const { return changeLog; }
+
+    void clearChanges() { changeLog.clear(); }
+
+    // Marks every cell changed, for views that show more of the board than the moves touch (debug mode's mines)
+    void markAllChanged();
+
+private:
+    const int numRows;
+    const int numCols;
+    const int mineCount;
+    const bool safeOpening;
+
+    GameBoard gameBoard;
+    std::uint64_t boardSeed = 0;
+    GameState gameState = GameState::InProgress;
+    // The layout is only final once the first tile is revealed (see commitFirstClick)
+    bool firstClickDone = false;
+    int mines = 0;
+    int flags = 0;
+    int revealed = 0;
+    std::vector<CellRect> changeLog;
+
+    void resetCounters();
+
+    void markChanged(const CellRect &rect);
+
+    void lose();
+
+    void checkWin();
+};
+
+#endif //MINESWEEPER_GAME_H
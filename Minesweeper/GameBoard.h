@@ -0,0 +1,13 @@
+#ifndef MINESWEEPER_GAMEBOARD_H
+#define MINESWEEPER_GAMEBOARD_H
+
+// Board backend used by the game, chosen at build time (see MINESWEEPER_BITBOARD in CMakeLists.txt)
+#ifdef MINESWEEPER_BITBOARD
+#include "BitBoard.h"
+typedef BitBoard GameBoard;
+#else
+#include "Board.h"
+typedef Board GameBoard;
+#endif
+
+#endif //MINESWEEPER_GAMEBOARD_H
@@ -0,0 +1,97 @@
+#include "Generator.h"
+#include <algorithm>
+#include <vector>
+#include "Rng.h"
+
+namespace {
+    // The cells within reach of (row, col), clipped to the board
+    CellRect around(const GameBoard &board, int row, int col, int reach) {
+        return CellRect{std::max(row - reach, 0), std::max(col - reach, 0), std::min(row + reach, board.rows() - 1),
+                        std::min(col + reach, board.cols() - 1)};
+    }
+}
+
+void initGame(GameBoard &board, const int &numRows, const int &numCols, const int &mineCount,
+              const std::uint64_t &seed) {
+    board.reset(numRows, numCols);
+    // Initialize the game board with random mine placement.
+    // The layout depends only on the seed, so the same seed always gives the same board.
+    BoardRng gen(seed);
+    const int cells = board.size();
+    const int mines = std::min(std::max(mineCount, 0), cells);
+    // Above 50% density it is cheaper to start full and pick the safe tiles instead
+    const bool pickSafe = mines * 2 > cells;
+    if (pickSafe) {
+        for (int i = 0; i < cells; i++) {
+            board.setMine(i);
+        }
+    }
+    // Floyd's sampling: picks distinct tiles in O(picks), however dense the board is.
+    // The board's own mine bits double as the "already picked" set.
+    const int picks = pickSafe ? cells - mines : mines;
+    for (int j = cells - picks; j < cells; j++) {
+        int t = static_cast<int>(gen.nextBelow(static_cast<std::uint64_t>(j) + 1));
+        // If t was already picked then j cannot have been, so take j instead
+        int pick = (board.isMine(t) != pickSafe) ? j : t;
+        if (pickSafe) {
+            board.clearMine(pick);
+        } else {
+            board.setMine(pick);
+        }
+    }
+    // Count the surrounding mines of every tile in one pass
+    board.computeAdjacency();
+}
+
+
+int commitFirstClick(GameBoard &board, const int &mineCount, const std::uint64_t &seed, const int &row,
+                     const int &col, const bool &safeOpening, std::vector<CellRect> &changed) {
+    const int reach = safeOpening ? 1 : 0;
+    // The opening and the neighbours of any mine taken out of it
+    changed.push_back(around(board, row, col, reach + 1));
+    std::vector<int> excluded;
+    for (int r = row - reach; r <= row + reach; r++) {
+        for (int c = col - reach; c <= col + reach; c++) {
+            if (board.inBounds(r, c)) {
+                excluded.push_back(board.index(r, c));
+            }
+        }
+    }
+    auto isExcluded = [&excluded](int i) {
+        return std::find(excluded.begin(), excluded.end(), i) != excluded.end();
+    };
+    const int cells = board.size();
+    int minesInside = 0;
+    for (int e: excluded) {
+        minesInside += board.isMine(e) ? 1 : 0;
+    }
+    int mines = std::min(std::max(mineCount, 0), cells);
+    int freeOutside = cells - static_cast<int>(excluded.size()) - (mines - minesInside);
+    // A separate stream from the one that laid out the board
+    BoardRng gen(~seed);
+    for (int e: excluded) {
+        if (!board.isMine(e)) {
+            continue;
+        }
+        board.clearMine(e);
+        if (freeOutside == 0) {
+            // Every other tile is already a mine, so this one is dropped
+            mines--;
+            continue;
+        }
+        int t, tries = 0;
+        do {
+            t = static_cast<int>(gen.nextBelow(static_cast<std::uint64_t>(cells)));
+        } while ((board.isMine(t) || isExcluded(t)) && ++tries < 64);
+        // Nearly full boards: walk forward to the next free tile instead of drawing forever
+        while (board.isMine(t) || isExcluded(t)) {
+            t = (t + 1) % cells;
+        }
+        board.setMine(t);
+        freeOutside--;
+        changed.push_back(around(board, t / board.cols(), t % board.cols(), 1));
+        board.computeAdjacency(t / board.cols() - 1, t / board.cols() + 1);
+    }
+    board.computeAdjacency(row - reach - 1, row + reach + 1);
+    return mines;
+}
@@ -0,0 +1,22 @@
+#ifndef MINESWEEPER_GENERATOR_H
+#define MINESWEEPER_GENERATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "GameBoard.h"
+
+// Resets the board and lays out mineCount mines (clamped to the board size) from the seed.
+// The layout depends only on the seed, so the same seed always gives the same board.
+void initGame(GameBoard &board, const int &numRows, const int &numCols, const int &mineCount,
+              const std::uint64_t &seed);
+
+// Commits the layout on the first reveal: any mine on the clicked tile (or its 3x3 neighbourhood when
+// safeOpening is set) is moved to another random tile, so the first click never loses.
+// Only the rows around moved mines are recounted, so this is O(1) regardless of board size,
+// and the final layout depends only on the seed and the first click.
+// Returns the number of mines left on the board (less than requested only if there was nowhere to move them),
+// and appends to changed the cells the move touched: the cleared opening and the 3x3 around every moved mine.
+int commitFirstClick(GameBoard &board, const int &mineCount, const std::uint64_t &seed, const int &row,
+                     const int &col, const bool &safeOpening, std::vector<CellRect> &changed);
+
+#endif //MINESWEEPER_GENERATOR_H
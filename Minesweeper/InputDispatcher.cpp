@@ -0,0 +1,59 @@
+#include "InputDispatcher.h"
+#include <algorithm>
+
+void InputDispatcher::on(sf::Event::EventType type, Handler handler) {
+    handlers[type].push_back(std::move(handler));
+}
+
+void InputDispatcher::onAny(Handler handler) {
+    anyHandlers.push_back(std::move(handler));
+}
+
+void InputDispatcher::push(const sf::Event &event) {
+    TimedEvent timed;
+    timed.event = event;
+    timed.received = std::chrono::high_resolution_clock::now();
+    queue.push_back(timed);
+}
+
+std::size_t InputDispatcher::poll(sf::Window &window) {
+    std::size_t count = 0;
+    sf::Event event{};
+    while (window.pollEvent(event)) {
+        push(event);
+        count++;
+    }
+    return count;
+}
+
+std::size_t InputDispatcher::wait(sf::Window &window) {
+    sf::Event event{};
+    if (!window.waitEvent(event)) {
+        return 0;
+    }
+    push(event);
+    return 1 + poll(window);
+}
+
+std::size_t InputDispatcher::dispatch() {
+    // Handlers may close the window, start a new game or switch scenes, but never add events,
+    // so indexing stays valid
+    std::size_t count = queue.size();
+    for (std::size_t i = 0; i < count; i++) {
+        for (const Handler &handler : handlers[queue[i].event.type]) {
+            handler(queue[i]);
+        }
+        for (const Handler &handler : anyHandlers) {
+            handler(queue[i]);
+        }
+    }
+    queue.clear();
+    frameCount += count;
+    return count;
+}
+
+void InputDispatcher::endFrame() {
+    lastFrameCount = frameCount;
+    maxFrameCount = std::max(maxFrameCount, frameCount);
+    frameCount = 0;
+}
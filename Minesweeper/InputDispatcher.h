@@ -0,0 +1,59 @@
+#ifndef MINESWEEPER_INPUTDISPATCHER_H
+#define MINESWEEPER_INPUTDISPATCHER_H
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// An SFML event with the time it was taken off the window's queue
+struct TimedEvent {
+    sf::Event event;
+    std::chrono::high_resolution_clock::time_point received;
+};
+
+/**
+ * Collects every event the window has queued and hands each one, in arrival order, to the handlers registered
+ * for its type. Nothing is coalesced, so fast click sequences reach the game exactly as they were made.
+ * SFML does not timestamp events, so each is stamped as soon as it is dequeued.
+ */
+class InputDispatcher {
+public:
+    typedef std::function<void(const TimedEvent &)> Handler;
+
+    // Handlers for the same type run in the order they were added
+    void on(sf::Event::EventType type, Handler handler);
+
+    // Handlers for every event run after the ones for its type
+    void onAny(Handler handler);
+
+    // Queues whatever the window has pending without blocking. Returns the number of events queued.
+    std::size_t poll(sf::Window &window);
+
+    // Blocks until the window has an event, then queues it and anything else pending
+    std::size_t wait(sf::Window &window);
+
+    // Runs the handlers for every queued event in order and empties the queue. Returns the number handled.
+    std::size_t dispatch();
+
+    // Closes the frame's event count; call once per drawn frame
+    void endFrame();
+
+    // Events dispatched during the last finished frame, and the most seen in any frame
+    std::size_t lastFrameEvents() const { return lastFrameCount; }
+
+    std::size_t maxFrameEvents() const { return maxFrameCount; }
+
+private:
+    std::vector<Handler> handlers[sf::Event::Count];
+    std::vector<Handler> anyHandlers;
+    std::vector<TimedEvent> queue;
+    std::size_t frameCount = 0;
+    std::size_t lastFrameCount = 0;
+    std::size_t maxFrameCount = 0;
+
+    void push(const sf::Event &event);
+};
+
+#endif //MINESWEEPER_INPUTDISPATCHER_H
@@ -0,0 +1,98 @@
+#include "LatencyProbe.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+    const char *const STAGE_NAMES[] = {"engine", "vertices", "submit", "display", "total"};
+
+    double millis(LatencyProbe::Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+LatencyProbe::LatencyProbe(std::size_t window) : capacity(std::max<std::size_t>(window, 1)) {
+}
+
+bool LatencyProbe::openCsv(const std::string &path) {
+    csv.open(path);
+    if (!csv) {
+        return false;
+    }
+    csv << "engine_us,vertices_us,submit_us,display_us,total_us" << std::endl;
+    return true;
+}
+
+void LatencyProbe::begin(Clock::time_point received) {
+    if (open) {
+        return;
+    }
+    open = true;
+    start = received;
+    std::fill(marked, marked + StageCount, false);
+}
+
+void LatencyProbe::mark(Stage stage) {
+    if (open) {
+        marks[stage] = Clock::now();
+        marked[stage] = true;
+    }
+}
+
+void LatencyProbe::finish() {
+    if (!open) {
+        return;
+    }
+    mark(Display);
+    open = false;
+    // A stage the frame skipped (e.g. no tile changed) takes no time
+    float sample[StageCount + 1];
+    Clock::time_point previous = start;
+    for (int stage = 0; stage < StageCount; stage++) {
+        Clock::time_point reached = marked[stage] ? std::max(marks[stage], previous) : previous;
+        sample[stage] = (float) millis(reached - previous);
+        previous = reached;
+    }
+    sample[StageCount] = (float) millis(previous - start);
+
+    for (int stage = 0; stage <= StageCount; stage++) {
+        if (history[stage].size() < capacity) {
+            history[stage].push_back(sample[stage]);
+        } else {
+            history[stage][next] = sample[stage];
+        }
+    }
+    next = (next + 1) % capacity;
+
+    if (csv) {
+        for (int stage = 0; stage <= StageCount; stage++) {
+            csv << (long long) (sample[stage] * 1000.0f) << (stage < StageCount ? ',' : '\n');
+        }
+        // Flushed per sample so the file is complete even if the game is killed
+        csv.flush();
+    }
+}
+
+double LatencyProbe::percentile(int stage, double p) const {
+    const std::vector<float> &values = history[stage];
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::vector<float> sorted(values);
+    std::size_t rank = (std::size_t) (p / 100.0 * (double) (sorted.size() - 1) + 0.5);
+    rank = std::min(rank, sorted.size() - 1);
+    std::nth_element(sorted.begin(), sorted.begin() + (std::ptrdiff_t) rank, sorted.end());
+    return sorted[rank];
+}
+
+std::string LatencyProbe::report() const {
+    std::string text = "click->display over last " + std::to_string(samples()) + " clicks (p50 / p99 ms)";
+    char line[64];
+    // Total first, then the stages it is made of
+    for (int i = 0; i <= StageCount; i++) {
+        int stage = (i + StageCount) % (StageCount + 1);
+        std::snprintf(line, sizeof(line), "\n%-9s %7.2f / %7.2f", STAGE_NAMES[stage], percentile(stage, 50.0),
+                      percentile(stage, 99.0));
+        text += line;
+    }
+    return text;
+}
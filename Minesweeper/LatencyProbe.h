@@ -0,0 +1,65 @@
+#ifndef MINESWEEPER_LATENCYPROBE_H
+#define MINESWEEPER_LATENCYPROBE_H
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * Measures click-to-photon latency: from the moment a mouse press is taken off the event queue
+ * to the return of the display() call that first shows its result.
+ * Each sample is split into stages so slow frames can be blamed on the game rules, the tile rebuild,
+ * or the GPU. Percentiles are taken over a rolling window of the most recent samples,
+ * and every sample can also be appended to a CSV file for offline analysis.
+ */
+class LatencyProbe {
+public:
+    typedef std::chrono::high_resolution_clock Clock;
+
+    // Stages in the order a frame passes through them; each is timed from the end of the previous one
+    enum Stage {
+        Engine,     // Game rules applied (reveal, flood fill, flag)
+        Vertices,   // Tile quads and the board cache brought up to date
+        Submit,     // Everything drawn, right before display()
+        Display,    // display() returned
+        StageCount
+    };
+
+    explicit LatencyProbe(std::size_t window = 512);
+
+    // Appends every sample to path as CSV, in microseconds. Returns false if the file can't be opened.
+    bool openCsv(const std::string &path);
+
+    // Starts a sample for an input received at the given time; ignored while one is already open,
+    // so a burst of clicks handled in one frame is timed from the earliest
+    void begin(Clock::time_point received);
+
+    // Records that the open sample reached stage; later marks of the same stage win
+    void mark(Stage stage);
+
+    // Marks Display and closes the open sample, if any
+    void finish();
+
+    // The p-th percentile (0-100) in milliseconds of one stage, or of the whole latency for StageCount
+    double percentile(int stage, double p) const;
+
+    std::size_t samples() const { return history[0].size(); }
+
+    // Multi-line p50/p99 summary for an on-screen overlay
+    std::string report() const;
+
+private:
+    std::size_t capacity;
+    bool open = false;
+    Clock::time_point start;
+    Clock::time_point marks[StageCount];
+    bool marked[StageCount] = {};
+    // Ring buffers of milliseconds, one per stage plus the total; next is the slot to overwrite once full
+    std::vector<float> history[StageCount + 1];
+    std::size_t next = 0;
+    std::ofstream csv;
+};
+
+#endif //MINESWEEPER_LATENCYPROBE_H
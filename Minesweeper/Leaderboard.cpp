@@ -0,0 +1,987 @@
+#include "Leaderboard.h"
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+const std::size_t Leaderboard::HEADER_SIZE;
+const std::size_t Leaderboard::RECORD_SIZE;
+const std::size_t Leaderboard::LOG_ENTRY_SIZE;
+const std::size_t Leaderboard::NAME_SIZE;
+const std::size_t Leaderboard::COMPACT_THRESHOLD;
+const std::size_t Leaderboard::CACHE_SIZE;
+
+namespace {
+    const char MAGIC[4] = {'M', 'S', 'L', 'B'};
+    const std::uint32_t VERSION = 1;
+    // Records read per chunk while merging the log into the sorted file
+    const std::size_t MERGE_CHUNK = 2048;
+    // How long the compactor waits before retrying after a failed compaction
+    const std::chrono::seconds RETRY_DELAY(5);
+
+    void put32(unsigned char *out, std::uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out[i] = (unsigned char) (value >> (8 * i));
+        }
+    }
+
+    std::uint32_t get32(const unsigned char *in) {
+        return (std::uint32_t) in[0] | ((std::uint32_t) in[1] << 8) | ((std::uint32_t) in[2] << 16) |
+               ((std::uint32_t) in[3] << 24);
+    }
+
+    off_t recordOffset(std::size_t index) {
+        return (off_t) (Leaderboard::HEADER_SIZE + index * Leaderboard::RECORD_SIZE);
+    }
+
+    // pread/pwrite until everything is transferred
+    bool readFully(int fd, void *data, std::size_t length, off_t offset) {
+        char *bytes = static_cast<char *>(data);
+        while (length > 0) {
+            ssize_t n = pread(fd, bytes, length, offset);
+            if (n <= 0) {
+                return false;
+            }
+            bytes += n;
+            length -= (std::size_t) n;
+            offset += n;
+        }
+        return true;
+    }
+
+    bool writeFully(int fd, const void *data, std::size_t length, off_t offset) {
+        const char *bytes = static_cast<const char *>(data);
+        while (length > 0) {
+            ssize_t n = pwrite(fd, bytes, length, offset);
+            if (n <= 0) {
+                return false;
+            }
+            bytes += n;
+            length -= (std::size_t) n;
+            offset += n;
+        }
+        return true;
+    }
+
+    // FNV-1a over a log entry's record, so a torn or garbled entry is never replayed
+    std::uint32_t checksum(const unsigned char *bytes, std::size_t length) {
+        std::uint32_t hash = 2166136261u;
+        for (std::size_t i = 0; i < length; i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Finds where a history ends: its size in whole, intact entries and the sequence after its last one.
+    // A failed append is cut back, so only a crash mid-append leaves a torn entry, and only at the end;
+    // repair truncates it away.
+    bool historyEnd(int file, bool repair, std::size_t &size, std::uint32_t &next) {
+        struct stat info = {};
+        if (fstat(file, &info) != 0) {
+            return false;
+        }
+        size = (std::size_t) info.st_size / Leaderboard::LOG_ENTRY_SIZE * Leaderboard::LOG_ENTRY_SIZE;
+        unsigned char entry[Leaderboard::LOG_ENTRY_SIZE];
+        while (size > 0) {
+            if (!readFully(file, entry, sizeof(entry), (off_t) (size - sizeof(entry)))) {
+                return false;
+            }
+            if (get32(entry + Leaderboard::RECORD_SIZE) == checksum(entry, Leaderboard::RECORD_SIZE)) {
+                break;
+            }
+            size -= sizeof(entry);
+        }
+        if (repair && size != (std::size_t) info.st_size && ftruncate(file, (off_t) size) != 0) {
+            return false;
+        }
+        // Bytes 4..7 of a record are its sequence
+        next = size == 0 ? 0 : get32(entry + 4) + 1;
+        return true;
+    }
+
+    // Whether a store has any scores in its sorted file, log or history, as opposed to missing or just created
+    bool holdsScores(const std::string &path) {
+        struct stat info = {};
+        if (stat(path.c_str(), &info) == 0 && (std::size_t) info.st_size > Leaderboard::HEADER_SIZE) {
+            return true;
+        }
+        for (const char *suffix : {".log", ".history"}) {
+            if (stat((path + suffix).c_str(), &info) == 0 && info.st_size > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string directoryOf(const std::string &path) {
+        const std::size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? "." : path.substr(0, slash + 1);
+    }
+
+    std::string baseName(const std::string &path) {
+        const std::size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    // Makes a rename inside path's directory durable
+    void syncDirectory(const std::string &path) {
+        int dirFd = ::open(directoryOf(path).c_str(), O_RDONLY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            ::close(dirFd);
+        }
+    }
+
+    // Has write fill a new file beside path and syncs it. The name is unique, so processes don't share temp files.
+    template<typename Writer>
+    bool writeTemp(const std::string &path, std::string &tempPath, Writer write) {
+        std::vector<char> name(path.begin(), path.end());
+        const char suffix[] = ".XXXXXX";
+        name.insert(name.end(), suffix, suffix + sizeof(suffix));
+        int out = mkstemp(name.data());
+        if (out < 0) {
+            return false;
+        }
+        tempPath = name.data();
+        bool ok = fchmod(out, 0644) == 0 && write(out) && fsync(out) == 0;
+        ok = ::close(out) == 0 && ok;
+        if (!ok) {
+            std::remove(tempPath.c_str());
+        }
+        return ok;
+    }
+
+    // Renames a file from writeTemp over path, so path is always either the old file or the new one
+    bool commitTemp(const std::string &tempPath, const std::string &path) {
+        if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+        syncDirectory(path);
+        return true;
+    }
+
+    template<typename Writer>
+    bool replaceFile(const std::string &path, Writer write) {
+        std::string tempPath;
+        return writeTemp(path, tempPath, write) && commitTemp(tempPath, path);
+    }
+
+    // Holds an flock for its scope. Without flock (some network filesystems) the store is only safe for one process.
+    class FileLock {
+    public:
+        FileLock(int file, int operation) : file(file) {
+            while (file >= 0 && flock(file, operation) != 0 && errno == EINTR) {
+            }
+        }
+
+        ~FileLock() {
+            if (file >= 0) {
+                flock(file, LOCK_UN);
+            }
+        }
+
+        FileLock(const FileLock &) = delete;
+
+        FileLock &operator=(const FileLock &) = delete;
+
+    private:
+        const int file;
+    };
+
+    // Notes which file (by device and inode) an open descriptor refers to
+    template<typename State>
+    void remember(int file, State &state) {
+        struct stat info = {};
+        if (fstat(file, &info) == 0) {
+            state.device = info.st_dev;
+            state.inode = info.st_ino;
+        }
+    }
+
+#ifdef __linux__
+    // Empties the watch's event queue; true if any event was about one of names (or events were dropped)
+    bool drainEvents(int watchFd, const std::vector<std::string> &names) {
+        alignas(struct inotify_event) char buffer[4096];
+        bool relevant = false;
+        ssize_t n;
+        while ((n = read(watchFd, buffer, sizeof(buffer))) > 0) {
+            for (char *at = buffer; at < buffer + n;) {
+                const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(at);
+                if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 &&
+                    std::find(names.begin(), names.end(), event->name) != names.end())) {
+                    relevant = true;
+                }
+                at += sizeof(struct inotify_event) + event->len;
+            }
+        }
+        return relevant;
+    }
+#endif
+
+    // "MM:SS,Name" as written by the old text leaderboard
+    bool parseTextLine(const std::string &line, int &seconds, std::string &name) {
+        std::size_t colon = line.find(':');
+        std::size_t comma = line.find(',', colon == std::string::npos ? 0 : colon);
+        if (colon == std::string::npos || comma == std::string::npos || colon == 0 || comma == colon + 1) {
+            return false;
+        }
+        char *end = nullptr;
+        long minutes = std::strtol(line.c_str(), &end, 10);
+        if (end != line.c_str() + colon || minutes < 0) {
+            return false;
+        }
+        long secs = std::strtol(line.c_str() + colon + 1, &end, 10);
+        if (end != line.c_str() + comma || secs < 0 || secs >= 60) {
+            return false;
+        }
+        seconds = (int) (minutes * 60 + secs);
+        name = line.substr(comma + 1);
+        // Files edited on Windows end their lines in \r
+        if (!name.empty() && name.back() == '\r') {
+            name.pop_back();
+        }
+        return true;
+    }
+}
+
+Leaderboard::~Leaderboard() {
+    close();
+}
+
+void Leaderboard::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (compactor.joinable()) {
+        compactor.join();
+    }
+    // Logged scores stay in the log and are replayed by the next open
+    for (int *file : {&fd, &logFd, &lockFd, &historyFd, &watchFd}) {
+        if (*file >= 0) {
+            ::close(*file);
+            *file = -1;
+        }
+    }
+    count = 0;
+    capacity = 0;
+    logSize = 0;
+    fileSequence = 0;
+    nextSequence = 0;
+    head.clear();
+    pending.clear();
+    reloaded = false;
+    fileState = FileState();
+    logState = FileState();
+    stopping = false;
+}
+
+std::string LeaderboardKey::fileName() const {
+    std::string rules = ruleset;
+    for (char &c : rules) {
+        if (!std::isalnum((unsigned char) c) && c != '-') {
+            c = '_';
+        }
+    }
+    return std::to_string(columns) + "x" + std::to_string(rows) + "-" + std::to_string(mines) + "-" + rules + ".bin";
+}
+
+bool Leaderboard::open(const std::string &storePath, std::size_t keep) {
+    close();
+    path = storePath;
+    capacity = keep;
+    logPath = storePath + ".log";
+#ifdef __linux__
+    // Watched before anything is read, so no change made after the read goes unnoticed
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watchFd >= 0 &&
+        inotify_add_watch(watchFd, directoryOf(path).c_str(), IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_DELETE) < 0) {
+        ::close(watchFd);
+        watchFd = -1;
+    }
+#endif
+    lockFd = ::open((path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0) {
+        close();
+        return false;
+    }
+    {
+        // Another process may be creating the store or appending to the log right now
+        FileLock exclusive(lockFd, LOCK_EX);
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat info = {};
+        bool ok = fd >= 0 && fstat(fd, &info) == 0 && (info.st_size > 0 || writeHeader(fd, 0)) && loadFile(fd);
+        if (ok) {
+            logFd = ::open(logPath.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+            ok = logFd >= 0 && readLog(true);
+        }
+        if (ok) {
+            // Before the first compaction can drop anything, the history gets whatever it is missing
+            historyFd = ::open((path + ".history").c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+            ok = historyFd >= 0 && fillHistory();
+        }
+        if (!ok) {
+            close();
+            return false;
+        }
+        remember(logFd, logState);
+    }
+    compactor = std::thread(&Leaderboard::compactLoop, this);
+    return true;
+}
+
+std::size_t Leaderboard::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return count + pending.size();
+}
+
+std::size_t Leaderboard::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+std::size_t Leaderboard::rankOf(int seconds) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto after = std::upper_bound(pending.begin(), pending.end(), seconds, [](int value, const Record &r) {
+        return value < (int) r.seconds;
+    });
+    return fileRankOf(seconds) + (std::size_t) (after - pending.begin());
+}
+
+std::size_t Leaderboard::fileRankOf(int seconds) const {
+    // Upper bound: a new score goes after every score that is better or equal
+    std::size_t low = 0, high = count;
+    // The cached head settles any time that ranks inside it without touching the file
+    if (head.size() == count || (!head.empty() && (int) head.back().seconds > seconds)) {
+        low = 0;
+        high = head.size();
+        while (low < high) {
+            std::size_t mid = low + (high - low) / 2;
+            if ((int) head[mid].seconds <= seconds) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        return low;
+    }
+    Record record;
+    while (low < high) {
+        std::size_t mid = low + (high - low) / 2;
+        if (!readAt(mid, record)) {
+            return count;
+        }
+        if ((int) record.seconds <= seconds) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+long Leaderboard::insert(int seconds, const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!append(std::vector<Score>(1, Score{seconds, name}))) {
+        return -1;
+    }
+    // Equal times keep insertion order, so the new score is the last one with its time
+    const auto after = std::upper_bound(pending.begin(), pending.end(), seconds, [](int value, const Record &r) {
+        return value < (int) r.seconds;
+    });
+    return (long) (fileRankOf(seconds) + (std::size_t) (after - pending.begin())) - 1;
+}
+
+bool Leaderboard::insert(const std::vector<Score> &scores) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return append(scores);
+}
+
+bool Leaderboard::append(const std::vector<Score> &scores) {
+    if (fd < 0) {
+        return false;
+    }
+    FileLock exclusive(lockFd, LOCK_EX);
+    // Take in what other processes appended first: the entries then land where logSize says, and their
+    // sequences stay above every other process's
+    if (changedOnDisk() && !reload()) {
+        return false;
+    }
+    std::vector<Record> records;
+    std::vector<unsigned char> bytes(scores.size() * LOG_ENTRY_SIZE);
+    for (std::size_t i = 0; i < scores.size(); i++) {
+        records.push_back(makeRecord(scores[i].seconds, nextSequence + (std::uint32_t) i, scores[i].name));
+        unsigned char *entry = &bytes[i * LOG_ENTRY_SIZE];
+        encode(records.back(), entry);
+        put32(entry + RECORD_SIZE, checksum(entry, RECORD_SIZE));
+    }
+    // The entries go out in one append, and the scores only count once they are on disk
+    if (write(logFd, bytes.data(), bytes.size()) != (ssize_t) bytes.size() || fsync(logFd) != 0) {
+        // Cut off a partial append so later ones still line up
+        if (ftruncate(logFd, (off_t) logSize) != 0) {
+            std::perror(logPath.c_str());
+        }
+        return false;
+    }
+    logSize += bytes.size();
+    nextSequence += (std::uint32_t) records.size();
+    for (const Record &record : records) {
+        pending.insert(std::upper_bound(pending.begin(), pending.end(), record, before), record);
+    }
+    if (pending.size() >= COMPACT_THRESHOLD) {
+        wake.notify_one();
+    }
+    return true;
+}
+
+std::vector<Score> Leaderboard::top(std::size_t n) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Score> scores;
+    const std::size_t fromFile = std::min(n, count);
+    std::vector<Record> best;
+    if (fromFile <= head.size()) {
+        best.assign(head.begin(), head.begin() + fromFile);
+    } else {
+        std::vector<unsigned char> bytes(fromFile * RECORD_SIZE);
+        if (!readFully(fd, bytes.data(), bytes.size(), recordOffset(0))) {
+            return scores;
+        }
+        for (std::size_t i = 0; i < fromFile; i++) {
+            best.push_back(decode(&bytes[i * RECORD_SIZE]));
+        }
+    }
+    // Merge the best of the sorted file with the logged scores
+    std::size_t i = 0, j = 0;
+    while (scores.size() < n && (i < best.size() || j < pending.size())) {
+        const Record &record = i >= best.size() || (j < pending.size() && before(pending[j], best[i])) ?
+                               pending[j++] : best[i++];
+        scores.push_back(Score{(int) record.seconds, std::string(record.name, strnlen(record.name, NAME_SIZE))});
+    }
+    return scores;
+}
+
+bool Leaderboard::refresh() {
+    // A compaction holds the sorted file open for reading, so swapping files waits for the next call
+    std::unique_lock<std::mutex> serial(compactMutex, std::try_to_lock);
+    if (!serial.owns_lock()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fd >= 0 && changedOnDisk()) {
+        // Shared, so another process's file swap is never seen half done
+        FileLock shared(lockFd, LOCK_SH);
+        reload();
+    }
+    // Inserts and compactions also read in other processes' changes, and those count too
+    const bool changed = reloaded;
+    reloaded = false;
+    return changed;
+}
+
+bool Leaderboard::compact() {
+    std::lock_guard<std::mutex> serial(compactMutex);
+    std::vector<Record> merged;
+    std::uint32_t through;
+    std::size_t fileCount;
+    std::uint32_t source;
+    int in;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (fd < 0) {
+            return false;
+        }
+        FileLock exclusive(lockFd, LOCK_EX);
+        if (changedOnDisk() && !reload()) {
+            return false;
+        }
+        // A file swapped in by another process (an import, say) may hold records the history lacks, and this
+        // compaction may drop them
+        if (!fillHistory()) {
+            return false;
+        }
+        // Also run with nothing logged when the file holds more than the capacity (say, after an import)
+        if (pending.empty() && (capacity == 0 || count <= capacity)) {
+            return true;
+        }
+        merged = pending;
+        through = nextSequence;
+        fileCount = count;
+        // Every compaction raises the sorted file's next sequence, so it tells whether the file was replaced since
+        source = fileSequence;
+        // Inserts may swap fd after reading in another process's compaction, so the merge reads its own copy
+        in = dup(fd);
+        if (in < 0) {
+            return false;
+        }
+    }
+    // The merge holds no lock: inserts here and in other processes go on meanwhile
+    std::vector<Record> newHead;
+    std::string tempPath;
+    const bool written = writeTemp(path, tempPath, [&](int out) {
+        if (!writeHeader(out, through)) {
+            return false;
+        }
+        std::vector<unsigned char> inBytes;
+        std::vector<unsigned char> outBytes;
+        std::size_t next = 0;
+        std::size_t done = 0;
+        std::size_t kept = 0;
+        auto emit = [&](const Record &record) {
+            // Everything after the best capacity records is dropped
+            if (capacity != 0 && kept == capacity) {
+                return;
+            }
+            kept++;
+            outBytes.resize(outBytes.size() + RECORD_SIZE);
+            encode(record, &outBytes[outBytes.size() - RECORD_SIZE]);
+            if (newHead.size() < CACHE_SIZE) {
+                newHead.push_back(record);
+            }
+        };
+        auto flush = [&]() {
+            const bool ok = writeFully(out, outBytes.data(), outBytes.size(), recordOffset(done));
+            done += outBytes.size() / RECORD_SIZE;
+            outBytes.clear();
+            return ok;
+        };
+        for (std::size_t start = 0; start < fileCount; start += MERGE_CHUNK) {
+            const std::size_t chunk = std::min(MERGE_CHUNK, fileCount - start);
+            inBytes.resize(chunk * RECORD_SIZE);
+            if (!readFully(in, inBytes.data(), inBytes.size(), recordOffset(start))) {
+                return false;
+            }
+            for (std::size_t k = 0; k < chunk; k++) {
+                const Record record = decode(&inBytes[k * RECORD_SIZE]);
+                while (next < merged.size() && before(merged[next], record)) {
+                    emit(merged[next++]);
+                }
+                emit(record);
+            }
+            if (!flush()) {
+                return false;
+            }
+        }
+        while (next < merged.size()) {
+            emit(merged[next++]);
+        }
+        return flush();
+    });
+    ::close(in);
+    if (!written) {
+        // The old file is still in place and the scores are still pending, so nothing is lost
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    FileLock exclusive(lockFd, LOCK_EX);
+    if (changedOnDisk() && !reload()) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    if (fileSequence != source) {
+        // Another process compacted first; whatever its file lacks is still in the log and in pending
+        std::remove(tempPath.c_str());
+        return true;
+    }
+    // The merged scores reach the history before the new file (which may have dropped some) replaces the old one
+    if (!appendHistory(merged)) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    const int newFd = commitTemp(tempPath, path) ? ::open(path.c_str(), O_RDWR) : -1;
+    if (newFd < 0) {
+        return false;
+    }
+    ::close(fd);
+    fd = newFd;
+    remember(fd, fileState);
+    count = capacity == 0 ? fileCount + merged.size() : std::min(capacity, fileCount + merged.size());
+    fileSequence = through;
+    head.swap(newHead);
+    // Scores logged while the merge ran stay pending
+    pending.erase(std::remove_if(pending.begin(), pending.end(), [through](const Record &r) {
+        return r.sequence < through;
+    }), pending.end());
+    return rewriteLog();
+}
+
+bool Leaderboard::loadFile(int file) {
+    struct stat info = {};
+    unsigned char header[HEADER_SIZE];
+    if (fstat(file, &info) != 0 || (std::size_t) info.st_size < HEADER_SIZE ||
+        !readFully(file, header, HEADER_SIZE, 0) || std::memcmp(header, MAGIC, sizeof(MAGIC)) != 0 ||
+        get32(header + 4) != VERSION || get32(header + 8) != RECORD_SIZE) {
+        return false;
+    }
+    const std::size_t records = ((std::size_t) info.st_size - HEADER_SIZE) / RECORD_SIZE;
+    std::vector<unsigned char> bytes(std::min(records, CACHE_SIZE) * RECORD_SIZE);
+    if (!bytes.empty() && !readFully(file, bytes.data(), bytes.size(), recordOffset(0))) {
+        return false;
+    }
+    head.clear();
+    for (std::size_t i = 0; i < bytes.size(); i += RECORD_SIZE) {
+        head.push_back(decode(&bytes[i]));
+    }
+    count = records;
+    fileSequence = get32(header + 12);
+    nextSequence = std::max(nextSequence, fileSequence);
+    remember(file, fileState);
+    return true;
+}
+
+bool Leaderboard::readLog(bool repair) {
+    struct stat info = {};
+    if (fstat(logFd, &info) != 0) {
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::size_t) info.st_size > logSize ? (std::size_t) info.st_size - logSize : 0);
+    if (!bytes.empty() && !readFully(logFd, bytes.data(), bytes.size(), (off_t) logSize)) {
+        return false;
+    }
+    std::size_t valid = 0;
+    while (valid + LOG_ENTRY_SIZE <= bytes.size() &&
+           get32(&bytes[valid + RECORD_SIZE]) == checksum(&bytes[valid], RECORD_SIZE)) {
+        const Record record = decode(&bytes[valid]);
+        // Entries below the sorted file's next sequence were merged into it before a crash cut the compaction short
+        if (record.sequence >= fileSequence) {
+            pending.push_back(record);
+            nextSequence = std::max(nextSequence, record.sequence + 1);
+        }
+        valid += LOG_ENTRY_SIZE;
+    }
+    // Whatever follows the last whole entry is an append that never finished
+    if (repair && valid < bytes.size() && ftruncate(logFd, (off_t) (logSize + valid)) != 0) {
+        return false;
+    }
+    logSize += valid;
+    std::sort(pending.begin(), pending.end(), before);
+    return true;
+}
+
+bool Leaderboard::changedOnDisk() {
+#ifdef __linux__
+    if (watchFd >= 0 && !drainEvents(watchFd, {baseName(path), baseName(logPath)})) {
+        return false;
+    }
+#endif
+    // Polled directly where there is no watch; with one, this tells other processes' changes from this one's own
+    struct stat file = {};
+    struct stat log = {};
+    if (stat(path.c_str(), &file) != 0 || stat(logPath.c_str(), &log) != 0) {
+        // Deleted out from under the game: keep what was read
+        return false;
+    }
+    return file.st_dev != fileState.device || file.st_ino != fileState.inode || log.st_dev != logState.device ||
+           log.st_ino != logState.inode || (std::size_t) log.st_size != logSize;
+}
+
+bool Leaderboard::reload() {
+    reloaded = true;
+    struct stat file = {};
+    struct stat log = {};
+    if (stat(path.c_str(), &file) != 0 || stat(logPath.c_str(), &log) != 0) {
+        return false;
+    }
+    // Another process's compaction renamed a new sorted file into place
+    const bool fileReplaced = file.st_dev != fileState.device || file.st_ino != fileState.inode;
+    if (fileReplaced) {
+        const int newFd = ::open(path.c_str(), O_RDWR);
+        if (newFd < 0 || !loadFile(newFd)) {
+            if (newFd >= 0) {
+                ::close(newFd);
+            }
+            return false;
+        }
+        ::close(fd);
+        fd = newFd;
+    }
+    const bool logReplaced = log.st_dev != logState.device || log.st_ino != logState.inode;
+    if (logReplaced) {
+        const int newLogFd = ::open(logPath.c_str(), O_RDWR | O_APPEND);
+        if (newLogFd < 0) {
+            return false;
+        }
+        ::close(logFd);
+        logFd = newLogFd;
+        remember(logFd, logState);
+    }
+    // Unless the log only grew, everything in it is read again
+    if (fileReplaced || logReplaced || (std::size_t) log.st_size < logSize) {
+        pending.clear();
+        logSize = 0;
+    }
+    return readLog(false);
+}
+
+bool Leaderboard::rewriteLog() {
+    if (pending.empty()) {
+        logSize = 0;
+        return ftruncate(logFd, 0) == 0 && fsync(logFd) == 0;
+    }
+    std::vector<unsigned char> bytes(pending.size() * LOG_ENTRY_SIZE);
+    for (std::size_t i = 0; i < pending.size(); i++) {
+        unsigned char *entry = &bytes[i * LOG_ENTRY_SIZE];
+        encode(pending[i], entry);
+        put32(entry + RECORD_SIZE, checksum(entry, RECORD_SIZE));
+    }
+    if (!replaceFile(logPath, [&bytes](int out) {
+        return writeFully(out, bytes.data(), bytes.size(), 0);
+    })) {
+        // The old log still holds every pending score; the merged ones are skipped when it is replayed
+        return false;
+    }
+    const int newLogFd = ::open(logPath.c_str(), O_RDWR | O_APPEND);
+    if (newLogFd < 0) {
+        return false;
+    }
+    ::close(logFd);
+    logFd = newLogFd;
+    remember(logFd, logState);
+    logSize = bytes.size();
+    return true;
+}
+
+bool Leaderboard::appendHistory(std::vector<Record> records) {
+    std::size_t size;
+    std::uint32_t next;
+    if (!historyEnd(historyFd, true, size, next)) {
+        return false;
+    }
+    // A compaction that crashed after appending left its scores in the log, so they come round again
+    records.erase(std::remove_if(records.begin(), records.end(), [next](const Record &r) {
+        return r.sequence < next;
+    }), records.end());
+    if (records.empty()) {
+        return true;
+    }
+    std::sort(records.begin(), records.end(), [](const Record &a, const Record &b) {
+        return a.sequence < b.sequence;
+    });
+    std::vector<unsigned char> bytes(records.size() * LOG_ENTRY_SIZE);
+    for (std::size_t i = 0; i < records.size(); i++) {
+        unsigned char *entry = &bytes[i * LOG_ENTRY_SIZE];
+        encode(records[i], entry);
+        put32(entry + RECORD_SIZE, checksum(entry, RECORD_SIZE));
+    }
+    if (write(historyFd, bytes.data(), bytes.size()) != (ssize_t) bytes.size() || fsync(historyFd) != 0) {
+        if (ftruncate(historyFd, (off_t) size) != 0) {
+            std::perror((path + ".history").c_str());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool Leaderboard::fillHistory() {
+    std::size_t size;
+    std::uint32_t next;
+    if (!historyEnd(historyFd, true, size, next)) {
+        return false;
+    }
+    // Usually the history is already past every record in the sorted file, and there is nothing to read
+    if (next >= fileSequence) {
+        return true;
+    }
+    std::vector<Record> missing;
+    std::vector<unsigned char> bytes;
+    for (std::size_t start = 0; start < count; start += MERGE_CHUNK) {
+        const std::size_t chunk = std::min(MERGE_CHUNK, count - start);
+        bytes.resize(chunk * RECORD_SIZE);
+        if (!readFully(fd, bytes.data(), bytes.size(), recordOffset(start))) {
+            return false;
+        }
+        for (std::size_t k = 0; k < chunk; k++) {
+            const Record record = decode(&bytes[k * RECORD_SIZE]);
+            if (record.sequence >= next) {
+                missing.push_back(record);
+            }
+        }
+    }
+    return appendHistory(missing);
+}
+
+std::vector<Score> Leaderboard::history() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<Score> scores;
+    if (fd < 0) {
+        return scores;
+    }
+    std::vector<unsigned char> bytes;
+    std::uint32_t next;
+    {
+        // Shared, so no other process's append is read half written
+        FileLock shared(lockFd, LOCK_SH);
+        std::size_t size;
+        if (!historyEnd(historyFd, false, size, next)) {
+            return scores;
+        }
+        bytes.resize(size);
+        if (!bytes.empty() && !readFully(historyFd, bytes.data(), bytes.size(), 0)) {
+            return scores;
+        }
+    }
+    auto add = [&scores](const Record &record) {
+        scores.push_back(Score{(int) record.seconds, std::string(record.name, strnlen(record.name, NAME_SIZE))});
+    };
+    for (std::size_t i = 0; i < bytes.size(); i += LOG_ENTRY_SIZE) {
+        add(decode(&bytes[i]));
+    }
+    // Then the scores still waiting in the log
+    std::vector<Record> logged;
+    std::copy_if(pending.begin(), pending.end(), std::back_inserter(logged), [next](const Record &r) {
+        return r.sequence >= next;
+    });
+    std::sort(logged.begin(), logged.end(), [](const Record &a, const Record &b) {
+        return a.sequence < b.sequence;
+    });
+    std::for_each(logged.begin(), logged.end(), add);
+    return scores;
+}
+
+void Leaderboard::compactLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] {
+            return stopping || pending.size() >= COMPACT_THRESHOLD || (capacity != 0 && count > capacity);
+        });
+        if (stopping) {
+            return;
+        }
+        lock.unlock();
+        const bool ok = compact();
+        lock.lock();
+        if (!ok) {
+            // Likely a full or read-only disk: the scores are safe in the log, so try again later
+            wake.wait_for(lock, RETRY_DELAY, [this] { return stopping; });
+        }
+    }
+}
+
+long Leaderboard::importText(const std::string &textPath, const std::string &binaryPath) {
+    std::ifstream text(textPath);
+    if (!text) {
+        return -1;
+    }
+    std::vector<Record> records;
+    std::string line;
+    int seconds;
+    std::string name;
+    while (std::getline(text, line)) {
+        if (parseTextLine(line, seconds, name)) {
+            records.push_back(makeRecord(seconds, (std::uint32_t) records.size(), name));
+        }
+    }
+    // The text file was kept sorted, but don't rely on hand edits having kept it that way
+    std::stable_sort(records.begin(), records.end(), before);
+
+    std::vector<unsigned char> bytes(records.size() * RECORD_SIZE);
+    for (std::size_t i = 0; i < records.size(); i++) {
+        encode(records[i], &bytes[i * RECORD_SIZE]);
+    }
+    const int lockFd = ::open((binaryPath + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0) {
+        return -1;
+    }
+    long imported;
+    {
+        // Instances started together may have created the store empty meanwhile, but must not lose scores to it;
+        // an empty one is replaced the way a compaction would replace it
+        FileLock exclusive(lockFd, LOCK_EX);
+        if (holdsScores(binaryPath)) {
+            imported = 0;
+        } else {
+            imported = replaceFile(binaryPath, [&](int out) {
+                return writeHeader(out, (std::uint32_t) records.size()) &&
+                       writeFully(out, bytes.data(), bytes.size(), recordOffset(0));
+            }) ? (long) records.size() : -1;
+        }
+    }
+    ::close(lockFd);
+    return imported;
+}
+
+int Leaderboard::adopt(const std::string &oldPath, const std::string &newPath) {
+    const int lockFd = ::open((newPath + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    if (lockFd < 0) {
+        return -1;
+    }
+    int moved = 0;
+    {
+        // Processes with the store at newPath open see the moved files as another process's compaction
+        FileLock exclusive(lockFd, LOCK_EX);
+        struct stat old = {};
+        if (!holdsScores(newPath) && stat(oldPath.c_str(), &old) == 0) {
+            // The sorted file first: a crash before the log follows loses at most its unmerged scores
+            moved = std::rename(oldPath.c_str(), newPath.c_str()) == 0 ? 1 : -1;
+            if (moved == 1 && stat((oldPath + ".log").c_str(), &old) == 0 &&
+                std::rename((oldPath + ".log").c_str(), (newPath + ".log").c_str()) != 0) {
+                moved = -1;
+            }
+            if (moved == 1) {
+                syncDirectory(newPath);
+                std::remove((oldPath + ".lock").c_str());
+            }
+        }
+    }
+    ::close(lockFd);
+    return moved;
+}
+
+void Leaderboard::encode(const Record &record, unsigned char *out) {
+    put32(out, record.seconds);
+    put32(out + 4, record.sequence);
+    std::memcpy(out + 8, record.name, NAME_SIZE);
+}
+
+Leaderboard::Record Leaderboard::decode(const unsigned char *in) {
+    Record record;
+    record.seconds = get32(in);
+    record.sequence = get32(in + 4);
+    std::memcpy(record.name, in + 8, NAME_SIZE);
+    return record;
+}
+
+Leaderboard::Record Leaderboard::makeRecord(int seconds, std::uint32_t sequence, const std::string &name) {
+    Record record;
+    record.seconds = (std::uint32_t) std::max(seconds, 0);
+    record.sequence = sequence;
+    std::memset(record.name, 0, NAME_SIZE);
+    std::memcpy(record.name, name.data(), std::min(name.size(), NAME_SIZE));
+    return record;
+}
+
+bool Leaderboard::before(const Record &a, const Record &b) {
+    return a.seconds != b.seconds ? a.seconds < b.seconds : a.sequence < b.sequence;
+}
+
+bool Leaderboard::writeHeader(int fd, std::uint32_t nextSequence) {
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    put32(header + 4, VERSION);
+    put32(header + 8, (std::uint32_t) RECORD_SIZE);
+    put32(header + 12, nextSequence);
+    return writeFully(fd, header, HEADER_SIZE, 0);
+}
+
+bool Leaderboard::readAt(std::size_t index, Record &record) const {
+    unsigned char bytes[RECORD_SIZE];
+    if (!readFully(fd, bytes, RECORD_SIZE, recordOffset(index))) {
+        return false;
+    }
+    record = decode(bytes);
+    return true;
+}
@@ -0,0 +1,224 @@
+#ifndef MINESWEEPER_LEADERBOARD_H
+#define MINESWEEPER_LEADERBOARD_H
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Score {
+    int seconds;
+    std::string name;
+};
+
+// What a time is ranked against: times only compare on the same board under the same rules
+struct LeaderboardKey {
+    int columns;
+    int rows;
+    int mines;
+    std::string ruleset;
+
+    // Store file name for this configuration, e.g. "25x16-50-classic.bin", so finding a configuration's
+    // leaderboard is one directory lookup however many configurations there are
+    std::string fileName() const;
+};
+
+/**
+ * Winning times kept in a binary file of fixed-size records sorted best first, so a score's place is found
+ * with a binary search over the records and the top N are one contiguous read, however long the history.
+ * Equal times keep their insertion order (every record carries a sequence number that breaks ties).
+ *
+ * New scores are not written into the sorted file. Each one is a single fsync'ed append to a write-ahead log
+ * next to it (path + ".log"), and is kept in memory until a background compaction merges the log into a new
+ * sorted file, written beside the old one and renamed over it. A crash at any point loses at most the score
+ * being appended: the sorted file is only ever replaced whole, and log entries the sorted file already holds
+ * (sequence below its header's next sequence) are skipped when the log is replayed on open.
+ *
+ * The best CACHE_SIZE records of the sorted file are kept in memory along with the logged scores, so showing the
+ * top of the board does no disk I/O. Other processes sharing the store are picked up by refresh(), which on Linux
+ * only looks at the files when an inotify watch on their directory reports a change, and elsewhere compares them
+ * with what was last read.
+ *
+ * Compaction also appends every score it merges to a history next to the store (path + ".history"), which is
+ * never rewritten or trimmed. A store opened with a capacity keeps only that many best times in the sorted file,
+ * so it stays small however many games are played; the times it drops are still in the history. With no capacity
+ * the sorted file keeps every score too. Opening a store whose history lacks some of the sorted file's records
+ * (one imported, or written before there was a history) adds them to it before anything can be dropped.
+ *
+ * Several processes may share a store. Every change to it (appending to the log, swapping in a compacted file)
+ * happens under an exclusive flock on path + ".lock", a file that is never replaced, after first reading in what
+ * the others appended; reloads take the lock shared. Compaction merges without the lock and only takes it to
+ * swap the result in, so other processes' inserts wait for a few small writes at most.
+ *
+ * Sorted file layout, little-endian: a HEADER_SIZE byte header (magic "MSLB", version, record size,
+ * next sequence), then RECORD_SIZE byte records of seconds (4), sequence (4) and the name (NAME_SIZE, zero
+ * padded). The log is a series of the same records, each followed by a 4 byte checksum, and so is the history,
+ * in sequence order.
+ */
+class Leaderboard {
+public:
+    static const std::size_t HEADER_SIZE = 16;
+    static const std::size_t RECORD_SIZE = 32;
+    static const std::size_t LOG_ENTRY_SIZE = RECORD_SIZE + 4;
+    // Longer names are cut to this many bytes
+    static const std::size_t NAME_SIZE = RECORD_SIZE - 8;
+    // Logged scores that wake the background compaction
+    static const std::size_t COMPACT_THRESHOLD = 64;
+    // Records at the top of the sorted file kept in memory
+    static const std::size_t CACHE_SIZE = 16;
+
+    Leaderboard() = default;
+
+    ~Leaderboard();
+
+    Leaderboard(const Leaderboard &) = delete;
+
+    Leaderboard &operator=(const Leaderboard &) = delete;
+
+    // Opens the store, creating an empty one if there is no file, and replays its log. capacity 0 keeps all scores.
+    // Returns false if it can't be opened or is not a leaderboard.
+    bool open(const std::string &path, std::size_t capacity = 0);
+
+    bool isOpen() const { return fd >= 0; }
+
+    // Number of scores stored. With a capacity this can run over it until the next compaction.
+    std::size_t size() const;
+
+    // Number of scores in the log that are not in the sorted file yet
+    std::size_t pendingCount() const;
+
+    // Logs a score and returns its rank (0 is the best), or -1 if it could not be written durably
+    long insert(int seconds, const std::string &name);
+
+    // Logs all the scores with one write and one fsync. Returns false (logging none of them) on failure.
+    bool insert(const std::vector<Score> &scores);
+
+    // The best n scores (fewer if there are not that many), best first
+    std::vector<Score> top(std::size_t n) const;
+
+    // Rank a new score with this time would get: the number of scores that are better or equal
+    std::size_t rankOf(int seconds) const;
+
+    // Reloads whatever another process changed since the last look. Returns true if the scores may have changed.
+    bool refresh();
+
+    // Merges the log into the sorted file now. Normally done in the background.
+    bool compact();
+
+    // Every score ever logged, oldest first, including the ones the capacity dropped from the ranking
+    std::vector<Score> history() const;
+
+    /**
+     * One-time conversion of the old text leaderboard ("MM:SS,Name" per line) into a new store at binaryPath.
+     * Lines that don't parse are skipped. The store is written to a temporary file and renamed into place,
+     * so binaryPath never holds a half-written import, and the scores join its history before any is dropped.
+     * Runs under the store's lock, so it is safe while other processes have the (empty) store open.
+     * Returns the number of scores imported, 0 if the store already holds scores (say, another process
+     * imported first), or -1 on failure.
+     */
+    static long importText(const std::string &textPath, const std::string &binaryPath);
+
+    /**
+     * One-time move of a store (sorted file and log) from oldPath to newPath, under newPath's lock like
+     * importText. Returns 1 if it was moved, 0 if newPath already holds scores or there is nothing at oldPath
+     * (either way oldPath is left alone), or -1 on failure.
+     */
+    static int adopt(const std::string &oldPath, const std::string &newPath);
+
+private:
+    struct Record {
+        std::uint32_t seconds;
+        std::uint32_t sequence;
+        char name[NAME_SIZE];
+    };
+
+    std::string path;
+    std::string logPath;
+    int fd = -1;
+    int logFd = -1;
+    int lockFd = -1;
+    int historyFd = -1;
+    // Most records the sorted file keeps, or 0 for all of them
+    std::size_t capacity = 0;
+    // Records in the sorted file
+    std::size_t count = 0;
+    // Bytes of whole entries in the log
+    std::size_t logSize = 0;
+    // Next sequence in the sorted file's header: the log entries below it are already in the file
+    std::uint32_t fileSequence = 0;
+    std::uint32_t nextSequence = 0;
+    // The first CACHE_SIZE records of the sorted file
+    std::vector<Record> head;
+    // Logged scores not in the sorted file yet, in leaderboard order
+    std::vector<Record> pending;
+
+    // The files as last read or written by this process, to tell other processes' changes from its own
+    struct FileState {
+        dev_t device = 0;
+        ino_t inode = 0;
+        off_t size = 0;
+    };
+    FileState fileState;
+    FileState logState;
+    // inotify instance watching the store's directory, or -1 when polling
+    int watchFd = -1;
+    // Set when another process's changes were read in, until refresh() reports it
+    bool reloaded = false;
+
+    // Guards everything above; compactions are serialised by compactMutex and only hold mutex to swap files
+    mutable std::mutex mutex;
+    std::mutex compactMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread compactor;
+
+    static void encode(const Record &record, unsigned char *out);
+
+    static Record decode(const unsigned char *in);
+
+    static Record makeRecord(int seconds, std::uint32_t sequence, const std::string &name);
+
+    static bool before(const Record &a, const Record &b);
+
+    static bool writeHeader(int fd, std::uint32_t nextSequence);
+
+    bool readAt(std::size_t index, Record &record) const;
+
+    // Rank within the sorted file alone; expects the lock held
+    std::size_t fileRankOf(int seconds) const;
+
+    // Appends the scores to the log and pending; expects the lock held
+    bool append(const std::vector<Score> &scores);
+
+    // Reads the header and head of the sorted file open as file into the fields above
+    bool loadFile(int file);
+
+    // Adds the log entries from logSize on to pending. At open, repair drops a torn entry at the end;
+    // later the last entry may just be mid-write by another process and is left for the next read.
+    bool readLog(bool repair);
+
+    // Whether the files on disk differ from fileState/logState; expects the lock held
+    bool changedOnDisk();
+
+    // Rereads the files after another process changed them; expects the lock held
+    bool reload();
+
+    // Replaces the log with one holding just the pending scores; expects the lock held
+    bool rewriteLog();
+
+    // Appends the records the history doesn't have yet (sequence at or past its end); expects the lock held
+    bool appendHistory(std::vector<Record> records);
+
+    // Adds the sorted file's records that are missing from the history; expects the lock held
+    bool fillHistory();
+
+    void compactLoop();
+
+    void close();
+};
+
+#endif //MINESWEEPER_LEADERBOARD_H
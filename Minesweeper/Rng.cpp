@@ -0,0 +1,51 @@
+#include "Rng.h"
+#include <cctype>
+#include <random>
+
+namespace {
+    const char SEED_ALPHABET[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+    const int SEED_CODE_LENGTH = 13;
+}
+
+std::uint64_t randomSeed() {
+    std::random_device rd;
+    return (static_cast<std::uint64_t>(rd()) << 32) ^ rd();
+}
+
+std::string encodeSeed(std::uint64_t seed) {
+    std::string code(SEED_CODE_LENGTH, '0');
+    for (int i = SEED_CODE_LENGTH - 1; i >= 0; i--) {
+        code[i] = SEED_ALPHABET[seed & 31];
+        seed >>= 5;
+    }
+    return code;
+}
+
+bool decodeSeed(const std::string &code, std::uint64_t &seed) {
+    if (code.empty() || code.size() > SEED_CODE_LENGTH) {
+        return false;
+    }
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < code.size(); i++) {
+        char c = static_cast<char>(std::toupper(static_cast<unsigned char>(code[i])));
+        if (c == 'I' || c == 'L') {
+            c = '1';
+        } else if (c == 'O') {
+            c = '0';
+        }
+        int digit = -1;
+        for (int d = 0; d < 32; d++) {
+            if (SEED_ALPHABET[d] == c) {
+                digit = d;
+                break;
+            }
+        }
+        // 13 base32 digits hold 65 bits, so a full-length code's first digit may only use the low 4
+        if (digit < 0 || (i == 0 && code.size() == SEED_CODE_LENGTH && digit > 15)) {
+            return false;
+        }
+        value = (value << 5) | static_cast<std::uint64_t>(digit);
+    }
+    seed = value;
+    return true;
+}
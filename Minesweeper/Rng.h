@@ -0,0 +1,93 @@
+#ifndef MINESWEEPER_RNG_H
+#define MINESWEEPER_RNG_H
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+/**
+ * xoshiro256** seeded through splitmix64: 32 bytes of state, so reseeding per game is free.
+ * Works as a UniformRandomBitGenerator, and nextBelow() gives bounded draws that are
+ * identical on every platform (unlike std::uniform_int_distribution), so a seed always
+ * produces the same board.
+ */
+class Xoshiro256 {
+public:
+    typedef std::uint64_t result_type;
+
+    explicit Xoshiro256(std::uint64_t seed) {
+        for (auto &word: s) {
+            seed += 0x9E3779B97F4A7C15ULL;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        const std::uint64_t result = rotl(s[1] * 5, 7) * 9;
+        const std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl(s[3], 45);
+        return result;
+    }
+
+    // Uniform value in [0, bound) by Lemire's multiply-shift; the division only runs in the rare rejection case
+    std::uint64_t nextBelow(std::uint64_t bound) {
+        std::uint64_t low;
+        std::uint64_t high = mul128((*this)(), bound, low);
+        if (low < bound) {
+            const std::uint64_t threshold = (0 - bound) % bound;
+            while (low < threshold) {
+                high = mul128((*this)(), bound, low);
+            }
+        }
+        return high;
+    }
+
+private:
+    std::uint64_t s[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    // Full 64x64 -> 128-bit product: returns the high half, stores the low half
+    static std::uint64_t mul128(std::uint64_t a, std::uint64_t b, std::uint64_t &low) {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        low = static_cast<std::uint64_t>(product);
+        return static_cast<std::uint64_t>(product >> 64);
+#else
+        const std::uint64_t aLo = a & 0xFFFFFFFFULL, aHi = a >> 32;
+        const std::uint64_t bLo = b & 0xFFFFFFFFULL, bHi = b >> 32;
+        const std::uint64_t ll = aLo * bLo, lh = aLo * bHi, hl = aHi * bLo, hh = aHi * bHi;
+        const std::uint64_t mid = (ll >> 32) + (lh & 0xFFFFFFFFULL) + (hl & 0xFFFFFFFFULL);
+        low = (mid << 32) | (ll & 0xFFFFFFFFULL);
+        return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+    }
+};
+
+// Generator used for board generation; swap the typedef to plug in another one with the same interface
+typedef Xoshiro256 BoardRng;
+
+// A fresh 64-bit seed from std::random_device
+std::uint64_t randomSeed();
+
+// Short shareable form of a seed: 13 characters of Crockford base32
+std::string encodeSeed(std::uint64_t seed);
+
+// Parses a seed code (case-insensitive, I/L read as 1 and O as 0). Returns false if it is not a valid code.
+bool decodeSeed(const std::string &code, std::uint64_t &seed);
+
+#endif //MINESWEEPER_RNG_H
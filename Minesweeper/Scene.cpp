@@ -0,0 +1,58 @@
+#include "Scene.h"
+#include <algorithm>
+
+void Scene::on(sf::Event::EventType type, InputDispatcher::Handler handler) {
+    handlers[type].push_back(std::move(handler));
+}
+
+void Scene::handle(const TimedEvent &event) const {
+    for (const InputDispatcher::Handler &handler : handlers[event.event.type]) {
+        handler(event);
+    }
+}
+
+void Scene::draw(sf::RenderTarget &target) const {
+    if (painter) {
+        painter(target);
+    }
+}
+
+void SceneStack::push(Scene &scene) {
+    scenes.push_back(&scene);
+}
+
+void SceneStack::pop() {
+    if (!scenes.empty()) {
+        scenes.pop_back();
+    }
+}
+
+void SceneStack::show(Scene &scene) {
+    scenes.assign(1, &scene);
+}
+
+bool SceneStack::contains(const Scene &scene) const {
+    return std::find(scenes.begin(), scenes.end(), &scene) != scenes.end();
+}
+
+void SceneStack::handle(const TimedEvent &event) const {
+    if (!scenes.empty()) {
+        // A handler may push or pop scenes, so the top is looked up once and not touched afterwards
+        const Scene *top = scenes.back();
+        top->handle(event);
+    }
+}
+
+void SceneStack::draw(sf::RenderTarget &target) const {
+    std::size_t first = scenes.size();
+    while (first > 0 && scenes[first - 1]->isOverlay()) {
+        first--;
+    }
+    // The opaque scene under the overlays (if any) is drawn first
+    if (first > 0) {
+        first--;
+    }
+    for (std::size_t i = first; i < scenes.size(); i++) {
+        scenes[i]->draw(target);
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef MINESWEEPER_SCENE_H
+#define MINESWEEPER_SCENE_H
+
+#include <SFML/Graphics.hpp>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "InputDispatcher.h"
+
+/**
+ * One screen of the game (the name prompt, the board, the leaderboard), drawn into the one shared window.
+ * A scene is a set of event handlers plus a painter; the SceneStack decides which scene gets the input
+ * and which ones are drawn. An overlay is drawn over the scenes below it and takes their input while it is up.
+ */
+class Scene {
+public:
+    typedef std::function<void(sf::RenderTarget &)> Painter;
+
+    explicit Scene(bool overlay = false) : overlay(overlay) {}
+
+    bool isOverlay() const { return overlay; }
+
+    // Handlers for the same type run in the order they were added
+    void on(sf::Event::EventType type, InputDispatcher::Handler handler);
+
+    void onDraw(Painter drawScene) { painter = std::move(drawScene); }
+
+    void handle(const TimedEvent &event) const;
+
+    void draw(sf::RenderTarget &target) const;
+
+private:
+    const bool overlay;
+    std::vector<InputDispatcher::Handler> handlers[sf::Event::Count];
+    Painter painter;
+};
+
+/**
+ * The scenes currently up, bottom first. Only the top one gets input.
+ * Scenes are owned by the caller and must outlive the stack; a scene may change the stack from its own handlers.
+ */
+class SceneStack {
+public:
+    // Covers the current scenes with another one
+    void push(Scene &scene);
+
+    void pop();
+
+    // Replaces every scene with this one
+    void show(Scene &scene);
+
+    bool contains(const Scene &scene) const;
+
+    // Gives an event to the top scene
+    void handle(const TimedEvent &event) const;
+
+    // Draws the top scene over the ones below it, starting from the highest scene that is not an overlay
+    void draw(sf::RenderTarget &target) const;
+
+private:
+    std::vector<Scene *> scenes;
+};
+
+#endif //MINESWEEPER_SCENE_H
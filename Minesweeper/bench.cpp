@@ -0,0 +1,67 @@
+#include <sys/resource.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "GameBoard.h"
+#include "Generator.h"
+#include "Rng.h"
+
+/**
+ * Flood fill benchmark: reveals the opening around randomly picked zero cells on a generated board and reports
+ * clicks per second, for whichever board backend the core was built with.
+ * Usage: minesweeper_bench [rows] [cols] [mine percent] [clicks]
+ */
+int main(int argc, char *argv[]) {
+    const int rows = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int cols = argc > 2 ? std::atoi(argv[2]) : 1000;
+    const double minePercent = argc > 3 ? std::atof(argv[3]) : 1.0;
+    const int clicks = argc > 4 ? std::atoi(argv[4]) : 30;
+    if (rows <= 0 || cols <= 0 || minePercent < 0 || minePercent > 100 || clicks <= 0) {
+        std::fprintf(stderr, "usage: %s [rows] [cols] [mine percent] [clicks]\n", argv[0]);
+        return 1;
+    }
+    const int mines = (int) ((double) rows * cols * minePercent / 100.0);
+
+    GameBoard board;
+    auto generateStart = std::chrono::steady_clock::now();
+    initGame(board, rows, cols, mines, 42);
+    const double generateMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generateStart).count();
+
+    // Clicks go on random empty cells, picked by rejection so the benchmark itself adds no per-cell memory
+    Xoshiro256 rng(7);
+    auto pickEmptyCell = [&]() {
+        for (long tries = 0; tries < 100L * board.size(); tries++) {
+            const int i = (int) rng.nextBelow((std::uint64_t) board.size());
+            if (!board.isMine(i) && board.adjacentMines(i) == 0) {
+                return i;
+            }
+        }
+        return -1;
+    };
+    double seconds = 0;
+    long revealed = 0;
+    for (int k = 0; k < clicks; k++) {
+        // Every click starts from a fully hidden board; only the fill itself is timed
+        for (int i = 0; i < board.size(); i++) {
+            board.setState(i, TileState::Hidden);
+        }
+        const int cell = pickEmptyCell();
+        if (cell < 0) {
+            std::fprintf(stderr, "no empty cells to click at %.1f%% mines\n", minePercent);
+            return 1;
+        }
+        CellRect changed;
+        auto start = std::chrono::steady_clock::now();
+        revealed += board.floodReveal(cell / cols, cell % cols, changed);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("%dx%d, %d mines: generated in %.1f ms\n", rows, cols, mines, generateMs);
+    std::printf("flood fill: %.1f clicks/s, %ld cells revealed per click\n", clicks / seconds, revealed / clicks);
+    std::printf("max RSS: %.1f MB (%.2f B/cell)\n", usage.ru_maxrss / 1024.0,
+                usage.ru_maxrss * 1024.0 / ((double) rows * cols));
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "Leaderboard.h"
+#include "Rng.h"
+
+namespace {
+    std::string scoreName(int writer, int i) {
+        return "w" + std::to_string(writer) + "_" + std::to_string(i);
+    }
+
+    // One forked writer: opens its own handle on the store and logs its scores, reading the board back now and
+    // then the way a running game does. Returns the writer's exit status, non-zero if any insert failed.
+    int runWriter(const std::string &path, std::size_t capacity, int writer, int scores, int batch) {
+        Leaderboard leaderboard;
+        if (!leaderboard.open(path, capacity)) {
+            return 2;
+        }
+        Xoshiro256 rng(static_cast<std::uint64_t>(writer) + 1);
+        std::vector<Score> queued;
+        for (int i = 0; i < scores; i++) {
+            Score score{static_cast<int>(rng.nextBelow(600)), scoreName(writer, i)};
+            if (batch <= 1) {
+                if (leaderboard.insert(score.seconds, score.name) < 0) {
+                    return 3;
+                }
+            } else {
+                queued.push_back(score);
+                if (static_cast<int>(queued.size()) == batch || i == scores - 1) {
+                    if (!leaderboard.insert(queued)) {
+                        return 3;
+                    }
+                    queued.clear();
+                }
+            }
+            if (i % 50 == 0) {
+                leaderboard.refresh();
+                leaderboard.top(5);
+            }
+        }
+        // Closing the store waits for a compaction in flight, as quitting the game does
+        return 0;
+    }
+}
+
+/**
+ * Leaderboard stress test: forks several writers that insert into one store at the same time, then checks that
+ * every score made it into the history exactly once, and that the ranking holds the best of them in order (all of
+ * them with no capacity). Exits non-zero on lost, duplicated or misordered scores.
+ * The store is created fresh as stress.bin in the given directory.
+ * Usage: leaderboard_stress [writers] [scores per writer] [batch size] [directory] [capacity]
+ */
+int main(int argc, char *argv[]) {
+    const int writers = argc > 1 ? std::atoi(argv[1]) : 8;
+    const int scores = argc > 2 ? std::atoi(argv[2]) : 500;
+    const int batch = argc > 3 ? std::atoi(argv[3]) : 1;
+    const std::string dir = argc > 4 ? argv[4] : ".";
+    const long capacity = argc > 5 ? std::atol(argv[5]) : 0;
+    if (writers <= 0 || scores <= 0 || batch <= 0 || capacity < 0) {
+        std::fprintf(stderr, "usage: %s [writers] [scores per writer] [batch size] [directory] [capacity]\n",
+                     argv[0]);
+        return 1;
+    }
+    const std::string path = dir + "/stress.bin";
+    for (const char *suffix: {"", ".log", ".lock", ".history"}) {
+        unlink((path + suffix).c_str());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int w = 0; w < writers; w++) {
+        const pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            _exit(runWriter(path, (std::size_t) capacity, w, scores, batch));
+        }
+    }
+    int failedWriters = 0;
+    int status = 0;
+    while (wait(&status) > 0) {
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failedWriters++;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Leaderboard leaderboard;
+    if (!leaderboard.open(path, (std::size_t) capacity) || !leaderboard.compact()) {
+        std::fprintf(stderr, "could not reopen %s\n", path.c_str());
+        return 1;
+    }
+    const std::vector<Score> history = leaderboard.history();
+    std::set<std::string> names;
+    long duplicated = 0;
+    // Seconds of every score, to tell which ones the ranking should hold
+    std::multiset<int> times;
+    for (const Score &score : history) {
+        if (!names.insert(score.name).second) {
+            duplicated++;
+        }
+        times.insert(score.seconds);
+    }
+    const std::vector<Score> stored = leaderboard.top(leaderboard.size());
+    std::map<std::string, int> historyTimes;
+    for (const Score &score : history) {
+        historyTimes[score.name] = score.seconds;
+    }
+    bool ranked = true;
+    auto best = times.begin();
+    for (std::size_t i = 0; i < stored.size(); i++) {
+        // In order, each one a score from the history, and together the best ones there are
+        const auto logged = historyTimes.find(stored[i].name);
+        if ((i > 0 && stored[i - 1].seconds > stored[i].seconds) || logged == historyTimes.end() ||
+            logged->second != stored[i].seconds || best == times.end() || *best++ != stored[i].seconds) {
+            ranked = false;
+        }
+    }
+    long missing = 0;
+    for (int w = 0; w < writers; w++) {
+        for (int i = 0; i < scores; i++) {
+            const std::string name = scoreName(w, i);
+            if (!names.count(name) && missing++ < 20) {
+                std::printf("missing %s\n", name.c_str());
+            }
+        }
+    }
+
+    const long expected = static_cast<long>(writers) * scores;
+    const long expectedRanked = capacity == 0 ? expected : std::min(capacity, expected);
+    std::printf("%d writers x %d scores, batch %d: %zu in the history of %ld, %ld missing, %ld duplicated\n",
+                writers, scores, batch, history.size(), expected, missing, duplicated);
+    std::printf("ranking: %zu of %ld%s\n", stored.size(), expectedRanked, ranked ? "" : ", not the best in order");
+    std::printf("%.2f s, %.0f scores/s\n", seconds, expected / seconds);
+    if (failedWriters > 0) {
+        std::printf("%d writers failed\n", failedWriters);
+    }
+    return missing == 0 && duplicated == 0 && ranked && failedWriters == 0 &&
+           static_cast<long>(history.size()) == expected && static_cast<long>(stored.size()) == expectedRanked ? 0 : 1;
+}
@@ -1,41 +1,47 @@
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <fstream>
-#include <random>
 #include <cstdlib>
 #include <chrono>
-#include <queue>
 #include <string>
-#include <set>
+#include <vector>
 #include <sstream>
-
-enum class GameState {
-    InProgress,
-    Win,
-    Lose,
-    Paused
-};
-enum class TileState {
-    Hidden,
-    Flagged,
-    Revealed
-};
-
-void display(const std::vector<std::vector<int>> &v) {
-    for (auto &i: v) {
-        for (int j: i) {
-            std::cout << std::setw(4) << j << " ";
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <sys/stat.h>
+#include "Game.h"
+#include "Leaderboard.h"
+#include "Generator.h"
+#include "Rng.h"
+#include "BoardPool.h"
+#include "AssetLoader.h"
+#include "Atlas.h"
+#include "BoardLod.h"
+#include "Camera.h"
+#include "BoardRenderer.h"
+#include "InputDispatcher.h"
+#include "LatencyProbe.h"
+#include "Scene.h"
+
+void display(const GameBoard &board) {
+    for (int i = 0; i < board.rows(); i++) {
+        for (int j = 0; j < board.cols(); j++) {
+            std::cout << std::setw(4) << (board.isMine(i, j) ? -1 : board.adjacentMines(i, j)) << " ";
         }
         std::cout << std::endl;
     }
 }
 
-void getWindowDimen(int &width, int &height, int &mineCount, int &tileCount) {
-    std::ifstream configFile("files/board_config.cfg");
+void getWindowDimen(const std::vector<char> *config, int &width, int &height, int &mineCount, int &tileCount,
+                    std::string &seedCode) {
+    std::istringstream configFile(config ? std::string(config->begin(), config->end()) : std::string());
 
     int numColumns = 0;
     int numRows = 0;
     configFile >> numColumns >> numRows >> mineCount >> tileCount;
+    // Optional fifth value: seed code for the first board
+    configFile >> seedCode;
     width = numColumns * 32;
     height = (numRows * 32) + 100;
 }
@@ -47,194 +53,129 @@ void setText(sf::Text &text, float x, float y) {
     text.setPosition(sf::Vector2f(x, y));
 }
 
-// (r-1)(c-1)       (r-1)c      (r-1)(c+1)
-// r(c-1)           rc          r(c+1)
-// (r+1)(c-1)       (r+1)c      (r+1)(c+1)
-void
-revealEmptyTiles(std::vector<std::vector<int>> &board, std::vector<std::vector<TileState>> &tileStates, const int &row,
-                 const int &col, int &tilesRevealed) {
-    std::queue<std::pair<int, int>> q;
-    std::set<std::pair<int, int>> visited;
-    q.emplace(row, col);    //Pushing the current tile
-    visited.insert({row, col});
-    while (!q.empty()) {
-        auto pos = q.front();
-        q.pop();
-        int r = pos.first, c = pos.second;
-        if (tileStates[r][c] == TileState::Revealed || board[r][c] == -1) {
-            continue;
-        }
-        if (tileStates[r][c] != TileState::Flagged) {
-            tileStates[r][c] = TileState::Revealed;
-            tilesRevealed++;
-        }
-        if (board[r][c] == 0) {
-            for (int dr = -1; dr <= 1; dr++) {
-                for (int dc = -1; dc <= 1; dc++) {
-                    int nr = r + dr, nc = c + dc;
-                    if (nr < 0 || nr >= board.size() || nc < 0 || nc >= board[0].size()) {
-                        continue;
-                    }
-                    if (visited.count({nr, nc}) == 0) {
-                        q.emplace(nr, nc);      //Pushing the neighbors of the current tile
-                        visited.insert({nr, nc});
-                    }
-                }
-            }
-        }
+// The top five leaderboard rows, formatted for display; the player's own entries are starred
+std::string leaderBoardText(const Leaderboard &leaderboard, const std::string &playerName) {
+    std::ostringstream leaderboardContent;
+    leaderboardContent << std::setfill('0');
+    char idx = '1';
+    for (const Score &score : leaderboard.top(5)) {
+        leaderboardContent << idx++ << ".\t" << std::setw(2) << score.seconds / 60 << ":" << std::setw(2)
+                           << score.seconds % 60 << "\t" << score.name << (score.name == playerName ? "*" : "")
+                           << "\n\n";
     }
+    return leaderboardContent.str();
 }
 
-
-void initGame(std::vector<std::vector<int>> &board, std::vector<std::vector<TileState>> &tileStates, const int &numRows,
-              const int &numCols, const int &mineCount) {
-    std::vector<std::vector<int>> gameBoard(numRows, std::vector<int>(numCols, 0));
-    std::vector<std::vector<TileState>> tileState(numRows, std::vector<TileState>(numCols, TileState::Hidden));
-    // Initialize the game board with random mine placement
-    // Use a random_device to generate a seed for the random number generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    for (int i = 0; i < mineCount; i++) {
-        int row, col;
-        do {
-            row = std::uniform_int_distribution<int>(0, numRows - 1)(gen);
-            col = std::uniform_int_distribution<int>(0, numCols - 1)(gen);
-        } while (gameBoard[row][col] == -1);
-        gameBoard[row][col] = -1;
-        // Increment the surrounding tiles
-        for (int j = row - 1; j <= row + 1; j++) {
-            for (int k = col - 1; k <= col + 1; k++) {
-                if (j >= 0 && j < numRows && k >= 0 && k < numCols && gameBoard[j][k] != -1) {
-                    gameBoard[j][k]++;
-                }
-            }
-        }
+void insert_score(Leaderboard &leaderboard, const int &t, const std::string &name, const bool &called) {
+    if (called)
+        return;
+    if (leaderboard.insert(t, name) < 0) {
+        std::cerr << "Failed to save the score!" << std::endl;
     }
-    board = gameBoard;
-    tileStates = tileState;
 }
 
-
-void
-displayLeaderBoard(const int &width, const int &height, const sf::Font &font, const std::string &playerName) {
-    // Create the SFML window
-    sf::RenderWindow leaderBoardWin(sf::VideoMode(width / 2, height / 2), "Leaderboard",
-                                    sf::Style::Titlebar | sf::Style::Close);
-    leaderBoardWin.setFramerateLimit(60);
-
-    // Set up the leaderboard text
-    sf::Text leaderboardText;
-    leaderboardText.setFont(font);
-    leaderboardText.setCharacterSize(18);
-    leaderboardText.setStyle(sf::Text::Bold);
-    leaderboardText.setFillColor(sf::Color::White);
-
-    // Open the leaderboard file and read its contents
-    std::ifstream leaderboardFile("files/leaderboard.txt");
-    std::string row;
-    std::string leaderboardContent;
-    char idx = '1';
-    int count = 0;
-    while (count < 5 && std::getline(leaderboardFile, row)) {
-        //If new score is inserted
-        std::string end = "\n\n";
-        if (row.substr(6, std::string::npos) == playerName)
-            end = "*\n\n";
-        row = ".\t" + row.substr(0, 5) + "\t" + row.substr(6, std::string::npos) + end;
-        std::string t = idx + row;
-        row = t;
-        idx++;
-        leaderboardContent += row;
-        count++;
-    }
-    // Set the leaderboard text content and position
-    leaderboardText.setString(leaderboardContent);
-    setText(leaderboardText, leaderBoardWin.getSize().x / 2.0f, leaderBoardWin.getSize().y / 2.0f + 20);
-
-    // Set up the leaderboard title text
-    sf::Text titleText;
-    titleText.setFont(font);
-    titleText.setCharacterSize(20);
-    titleText.setStyle(sf::Text::Bold | sf::Text::Underlined);
-    titleText.setString("LEADERBOARD");
-    titleText.setFillColor(sf::Color::White);
-
-    // Set the leaderboard title position
-    setText(titleText, leaderBoardWin.getSize().x / 2.0f, leaderBoardWin.getSize().y / 2.0f - 120);
-    // Run the SFML loop
-    while (leaderBoardWin.isOpen()) {
-        // Handle SFML events
-        sf::Event event;
-        while (leaderBoardWin.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                leaderBoardWin.close();
+// Opens the leaderboard for this board configuration. The first time, the scores of the old single leaderboard
+// (binary, or text before that) become the current configuration's, since that is most likely what they were set on.
+void loadLeaderBoard(Leaderboard &leaderboard, const LeaderboardKey &key, std::size_t capacity) {
+    const std::string dir = "files/leaderboards/";
+    const std::string path = dir + key.fileName();
+    const std::string oldPath = "files/leaderboard.bin";
+    const std::string textPath = "files/leaderboard.txt";
+    // Only the instance that creates the directory moves the old scores. It does so under the store's lock, so
+    // an instance that opens the store meanwhile sees it either empty or whole, and nothing is moved over scores.
+    if (mkdir(dir.c_str(), 0755) == 0) {
+        if (std::ifstream(oldPath)) {
+            const int moved = Leaderboard::adopt(oldPath, path);
+            if (moved < 0) {
+                std::cerr << "Failed to move " << oldPath << "!" << std::endl;
+            } else if (moved == 0) {
+                std::cerr << "Left " << oldPath << " in place: " << path << " already has scores" << std::endl;
+            }
+        } else if (std::ifstream(textPath)) {
+            long imported = Leaderboard::importText(textPath, path);
+            if (imported < 0) {
+                std::cerr << "Failed to import " << textPath << "!" << std::endl;
+            } else {
+                std::cout << "Imported " << imported << " scores from " << textPath << std::endl;
             }
         }
-
-        // Clear the window
-        leaderBoardWin.clear(sf::Color::Blue);
-        // Draw the leaderboard text and title
-        leaderBoardWin.draw(leaderboardText);
-        leaderBoardWin.draw(titleText);
-        // Display the window
-        leaderBoardWin.display();
     }
-
+    if (!leaderboard.open(path, capacity)) {
+        std::cerr << "Failed to open the leaderboard " << path << "!" << std::endl;
+    }
 }
 
-void insert_score(const int &t, const std::string &name, const bool &called) {
-    if (called)
-        return;
-    int mins = t / 60;
-    int secs = t % 60;
-
-    std::ostringstream oss;
-    oss << std::setfill('0') << std::setw(2) << mins << ":" << std::setw(2) << secs;
-    std::string time = oss.str();
-
-    // Open the leaderboard file and read its contents into a vector of strings
-    std::ifstream leaderboardFile("files/leaderboard.txt");
-    std::vector<std::string> leaderboardContent;
-    std::string line;
-    while (std::getline(leaderboardFile, line)) {
-        leaderboardContent.push_back(line);
-    }
-    leaderboardFile.close();
-
-    // Insert the new score into the appropriate position in the vector
-    bool inserted = false;
-    for (auto it = leaderboardContent.begin(); it != leaderboardContent.end(); ++it) {
-        std::string currentTime = it->substr(0, 5);
-        int minsTime = std::stoi(currentTime.substr(0, 2));
-        int secsTime = std::stoi(currentTime.substr(3, 2));
-        if (mins < minsTime || (mins == minsTime && secs < secsTime)) {
-            leaderboardContent.insert(it, time.append(",").append(name));
-            inserted = true;
-            break;
-        }
-    }
-    if (!inserted) {
-        leaderboardContent.push_back(time + "," + name);
-    }
 
-    // Open the leaderboard file and write the updated contents to it
-    std::ofstream leaderboardFileOut("files/leaderboard.txt");
-    for (const auto &l: leaderboardContent) {
-        leaderboardFileOut << l << std::endl;
+int main(int argc, char *argv[]) {
+    const auto launchTime = std::chrono::high_resolution_clock::now();
+    // --seed=<code> on the command line overrides the config.
+    // --safe-opening keeps the whole 3x3 area around the first click free of mines, not just the tile itself.
+    // --latency-csv=<path> appends every click-to-display latency sample to a CSV file.
+    // --assets=<dir> loads assets from dir (laid out like files/) in place of the built-in ones, where present.
+    // --full-history ranks against every winning time, not just the best LEADERBOARD_SIZE. Every time is kept in
+    // the configuration's history file either way.
+    std::string seedArg;
+    bool safeOpening = false;
+    bool fullHistory = false;
+    std::string latencyCsv;
+    std::string assetDir;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 7, "--seed=") == 0) {
+            seedArg = arg.substr(7);
+        } else if (arg == "--safe-opening") {
+            safeOpening = true;
+        } else if (arg == "--full-history") {
+            fullHistory = true;
+        } else if (arg.compare(0, 14, "--latency-csv=") == 0) {
+            latencyCsv = arg.substr(14);
+        } else if (arg.compare(0, 9, "--assets=") == 0) {
+            assetDir = arg.substr(9);
+            if (!assetDir.empty() && assetDir.back() != '/') {
+                assetDir += '/';
+            }
+        }
     }
-    leaderboardFileOut.close();
-}
 
+    // Every tile and HUD image lives in one atlas texture, so the frame never switches textures
+    Atlas atlas;
+    // Assets are read and decoded on worker threads while the welcome screen is up;
+    // only the texture and font creation are left for the main thread.
+    // Declared after the atlas so its workers are joined before the atlas goes away.
+    AssetLoader assets(assetDir);
+    assets.loadFile("font.ttf");
+    // The built-in images never change, so the packed atlas is only cached on disk for an asset override
+    const std::string atlasCache = assetDir.empty() ? std::string() : assetDir + "atlas_cache";
+    assets.run("atlas", [&atlas, &assets, atlasCache]() {
+        return atlas.compose("images/", atlasCache, assets);
+    });
 
-int main() {
     int width, height, mineCount, tileCount;
-    getWindowDimen(width, height, mineCount, tileCount);
+    std::string seedCode;
+    getWindowDimen(assets.file("board_config.cfg"), width, height, mineCount, tileCount, seedCode);
+    if (!seedArg.empty()) {
+        seedCode = seedArg;
+    }
     const int MINE_COUNT = mineCount;
-    sf::RenderWindow window(sf::VideoMode(width, height), "Welcome Window", sf::Style::Titlebar | sf::Style::Close);
+    //Grid size:
+    const int numRows = (height - 100) / 32;
+    const int numCols = width / 32;
+    // Boards bigger than the screen get a window that fits on it; the camera scrolls over the rest
+    sf::VideoMode desktop = sf::VideoMode::getDesktopMode();
+    width = std::min(width, (int) desktop.width * 9 / 10);
+    height = std::min(height, (int) desktop.height * 9 / 10);
+    std::uint64_t seed = randomSeed();
+    if (!seedCode.empty() && !decodeSeed(seedCode, seed)) {
+        std::cerr << "Ignoring invalid seed code " << seedCode << std::endl;
+    }
+    // The one window every scene is drawn into
+    sf::RenderWindow window(sf::VideoMode(width, height), "Minesweeper", sf::Style::Titlebar | sf::Style::Close);
     window.setFramerateLimit(60);
 
+    // sf::Font reads from the buffer for as long as it lives, and the loader keeps it until main returns
     sf::Font font;
-    if (!font.loadFromFile("files/font.ttf")) {
+    const std::vector<char> *fontBytes = assets.file("font.ttf");
+    if (!fontBytes || !font.loadFromMemory(fontBytes->data(), fontBytes->size())) {
         std::cerr << "Failed to load font!" << std::endl;
         return 1;
     }
@@ -257,418 +198,498 @@ int main() {
     inputText.setFillColor(sf::Color::Yellow);
     setText(inputText, (float) window.getSize().x / 2.0f, (float) window.getSize().y / 2.0f - 45);
 
-    sf::RectangleShape cursorBg(sf::Vector2f(2.0f, inputText.getGlobalBounds().height));
-    cursorBg.setFillColor(sf::Color::Transparent);
-
     std::string name = "|";
-
-    while (window.isOpen()) {
-        sf::Event event{};
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-                return 0;
-            }
-            inputText.setString(name);
-            if (event.type == sf::Event::TextEntered) {
-                if ((event.text.unicode >= 'A' && event.text.unicode <= 'Z') ||
-                    (event.text.unicode >= 'a' && event.text.unicode <= 'z') && name.size() < 11) {
-                    name.pop_back();
-                    name += static_cast<char>(event.text.unicode);
-                    name.push_back('|');     //Extra character for cursor
-                    inputText.setString(name);
-                    setText(inputText, (float) window.getSize().x / 2.0f, (float) window.getSize().y / 2.0f - 35);
-                } else if (event.text.unicode == '\b') {
-                    if (!name.empty()) {
-                        name.pop_back();    //To pop the cursor
-                        name.pop_back();    //To pop the character
-                        inputText.setString(name);
-                        name.push_back('|');
-                        setText(inputText, (float) window.getSize().x / 2.0f, (float) window.getSize().y / 2.0f - 35);
-                    }
-                }
-            }
-
-            if (event.type == sf::Event::KeyPressed) {
-                if (name.size() > 1 && event.key.code == sf::Keyboard::Enter) {
-                    name.pop_back();
-                    window.close();
-                }
-            }
-        }
-
-//        cursorBg.setPosition(inputText.getPosition().x - 5.0f, window.getSize().y / 2.0f - 45);
-        cursorBg.setSize(
-                sf::Vector2f(inputText.getGlobalBounds().width + 10.0f, inputText.getGlobalBounds().height + 10.0f));
-
-        window.clear(sf::Color::Blue); // set the background color to blue
-        window.draw(welcomeText);
-        window.draw(inputPromptText);
-        window.draw(inputText);
-
-        window.display();
-    }
-
-    // capitalize first letter, lowercase the rest
-    if (!name.empty()) {
-        name[0] = (char) std::toupper(name[0]);
-        for (int i = 1; i < name.size(); i++) {
-            name[i] = (char) std::tolower(name[i]);
-        }
-    }
+    inputText.setString(name);
+    // When the name was entered, for the startup report
+    std::chrono::high_resolution_clock::time_point nameEnteredTime;
 
     /**
-     * Game window setup
+     * Game setup
      */
-    //Grid size:
-    const int numRows = (height - 100) / 32;
-    const int numCols = width / 32;
-    // Create the game window
-    sf::RenderWindow gameWindow(sf::VideoMode(width, height), "Minesweeper", sf::Style::Titlebar | sf::Style::Close);
-    gameWindow.setFramerateLimit(60);
-    std::vector<std::vector<int>> gameBoard(numRows, std::vector<int>(numCols, 0));
-    std::vector<std::vector<TileState>> tileState(numRows, std::vector<TileState>(numCols, TileState::Hidden));
     // Initialize the game
-    GameState gameState = GameState::InProgress;
+    Game game(numRows, numCols, MINE_COUNT, safeOpening);
+    game.start(seed);
+    const GameBoard &gameBoard = game.board();
     bool addedNewScore = false;
-    initGame(gameBoard, tileState, numRows, numCols, MINE_COUNT);
-    // For debugging
-    display(gameBoard);
+    // Times are only ranked against games on the same board under the same opening rule
+    const std::size_t LEADERBOARD_SIZE = 100;
+    Leaderboard leaderboard;
+    const LeaderboardKey leaderboardKey{numCols, numRows, MINE_COUNT, safeOpening ? "safe-opening" : "classic"};
+    loadLeaderBoard(leaderboard, leaderboardKey, fullHistory ? 0 : LEADERBOARD_SIZE);
+    // Restarts take an already generated board from here instead of generating on the render thread
+    BoardPool boardPool(2, [numRows, numCols, MINE_COUNT](GameBoard &board, std::uint64_t boardSeed) {
+        initGame(board, numRows, numCols, MINE_COUNT, boardSeed);
+    });
 
 
 
     /**
-     * Loading the textures
+     * Textures: the atlas is only uploaded when the game starts (see startGame), so the sprites get their
+     * atlas entries then
      */
-    std::vector<sf::Texture> numberTextures;
-    for (int i = 1; i <= 8; i++) {
-        sf::Texture texture;
-        if (!texture.loadFromFile("files/images/number_" + std::to_string(i) + ".png")) {
-            std::cerr << "Failed to load number texture " << i << "!" << std::endl;
-            return 1;
-        }
-        numberTextures.push_back(texture);
-    }
-
-    sf::Texture mineTexture;
-    if (!mineTexture.loadFromFile("files/images/mine.png")) {
-        std::cerr << "Failed to load mine texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture hiddenTexture;
-    if (!hiddenTexture.loadFromFile("files/images/tile_hidden.png")) {
-        std::cerr << "Failed to load hidden tile texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture revealedTexture;
-    if (!revealedTexture.loadFromFile("files/images/tile_revealed.png")) {
-        std::cerr << "Failed to load revealed tile texture!" << std::endl;
-        return 1;
-    }
-
-    sf::Texture happyFaceTexture;
-    if (!happyFaceTexture.loadFromFile("files/images/face_happy.png")) {
-        std::cerr << "Failed to load happy face texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture winFaceTexture;
-    if (!winFaceTexture.loadFromFile("files/images/face_win.png")) {
-        std::cerr << "Failed to load win face texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture loseFaceTexture;
-    if (!loseFaceTexture.loadFromFile("files/images/face_lose.png")) {
-        std::cerr << "Failed to load lose face texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture digitsTexture;
-    if (!digitsTexture.loadFromFile("files/images/digits.png")) {
-        std::cerr << "Failed to load digits texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture debugTexture;
-    if (!debugTexture.loadFromFile("files/images/debug.png")) {
-        std::cerr << "Failed to load debug texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture pauseTexture;
-    if (!pauseTexture.loadFromFile("files/images/pause.png")) {
-        std::cerr << "Failed to load pause texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture playTexture;
-    if (!playTexture.loadFromFile("files/images/play.png")) {
-        std::cerr << "Failed to load play texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture flagTexture;
-    if (!flagTexture.loadFromFile("files/images/flag.png")) {
-        std::cerr << "Failed to load flag texture!" << std::endl;
-        return 1;
-    }
-    sf::Texture leaderboardTexture;
-    if (!leaderboardTexture.loadFromFile("files/images/leaderboard.png")) {
-        std::cerr << "Failed to load leaderboard texture!" << std::endl;
-        return 1;
-    }
-    sf::Sprite mineSprite(mineTexture);
-    sf::Sprite hiddenSprite(hiddenTexture);
-    sf::Sprite revealedSprite(revealedTexture);
-    std::vector<sf::Sprite> numberSprites;
-    sf::Sprite happyFaceSprite(happyFaceTexture);
-    sf::Sprite winFaceSprite(winFaceTexture);
-    sf::Sprite loseFaceSprite(loseFaceTexture);
-    sf::Sprite digitsSprite(digitsTexture);
-    sf::Sprite debugSprite(debugTexture);
-    sf::Sprite pauseSprite(playTexture);
-    sf::Sprite playSprite(pauseTexture);
-    sf::Sprite flagSprite(flagTexture);
-    sf::Sprite leaderBoardSprite(leaderboardTexture);
-    sf::Sprite timerSprite(digitsTexture);
-    for (int i = 0; i < 8; i++) {
-        sf::Sprite sprite(numberTextures[i]);
-        numberSprites.push_back(sprite);
-    }
+    const sf::Texture &atlasTexture = atlas.texture();
+    BoardRenderer boardRenderer(atlas);
+
+    sf::Sprite happyFaceSprite;
+    sf::Sprite winFaceSprite;
+    sf::Sprite loseFaceSprite;
+    sf::Sprite debugSprite;
+    sf::Sprite pauseSprite;
+    sf::Sprite playSprite;
+    sf::Sprite leaderBoardSprite;
+    const std::pair<sf::Sprite *, Atlas::Id> hudSprites[] = {
+            {&happyFaceSprite,   Atlas::FaceHappy},
+            {&winFaceSprite,     Atlas::FaceWin},
+            {&loseFaceSprite,    Atlas::FaceLose},
+            {&debugSprite,       Atlas::Debug},
+            {&pauseSprite,       Atlas::Play},
+            {&playSprite,        Atlas::Pause},
+            {&leaderBoardSprite, Atlas::Leaderboard},
+    };
+    // Seed code of the current board, shown under the mine counter so a board can be shared/replayed
+    sf::Text seedText(encodeSeed(game.seed()), font, 12);
+    seedText.setFillColor(sf::Color::Black);
+    seedText.setPosition(33.0f, (float) height - 100.0f + 68.0f);
     // Start the timer
     auto start_time = std::chrono::high_resolution_clock::now();
     // Elapsed time
     auto elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(
             std::chrono::high_resolution_clock::now() - start_time).count();
 
-    int tilesRevealed = 0;
     // For debugging
     bool isDebugging = false;
+    // Set when the tile vertices need to be brought up to date
+    bool boardDirty = true;
     auto pauseTime = std::chrono::high_resolution_clock::now();
-    //LeaderBoard Window controls
+    // Set once the leaderboard has been shown for the current win
     bool closed = false;
-    bool showInNextIter = false;
-    bool showLeaderBoard = false;
-    //Main looper
-    while (gameWindow.isOpen()) {
-        sf::Event event{};
-        while (gameWindow.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                gameWindow.close();
-            }
+    // Seconds the timer should show right now
+    auto timerSeconds = [&game, &start_time, &elapsed_time]() {
+        if (game.state() != GameState::InProgress) {
+            return elapsed_time;
         }
-        /**
-         * Click listeners
-         */
-        if (gameState == GameState::InProgress) {
-            // Handle left click
-            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-                //If the click was in between tiles
-                if (event.mouseButton.y <= height - 100) {
-                    int row = event.mouseButton.y / 32; // Calculate row based on mouse y-coordinate
-                    int col = event.mouseButton.x / 32; // Calculate column based on mouse x-coordinate
-                    if (tileState[row][col] != TileState::Flagged) { // Only reveal tile if it is not flagged
-                        if (gameBoard[row][col] == -1) { // Bomb tile
-                            // Reveal all bomb tiles
-                            for (int i = 0; i < numRows; i++) {
-                                for (int j = 0; j < numCols; j++) {
-                                    if (gameBoard[i][j] == -1) {
-                                        tileState[i][j] = TileState::Revealed;
-                                        tilesRevealed++;
-                                    }
-                                }
-                            }
-                            gameState = GameState::Lose;
-                        } else if (gameBoard[row][col] == 0) { // Empty tile
-                            //Reveal all adjacent empty tiles
-                            revealEmptyTiles(gameBoard, tileState, row, col, tilesRevealed);
-                        } else { // Number tile
-                            tileState[row][col] = TileState::Revealed;
-                            tilesRevealed++;
-                        }
-                    }
-                }
+        return std::chrono::duration_cast<std::chrono::seconds>(
+                std::chrono::high_resolution_clock::now() - start_time).count();
+    };
+    // Set when something on screen has to change; while it is clear the loop sleeps instead of redrawing
+    bool frameDirty = true;
+    bool firstFrameShown = false;
+    // Timer value currently on screen
+    auto shownSeconds = elapsed_time;
+    // How long to nap between input checks while only the timer is running
+    const sf::Time idleSlice = sf::milliseconds(5);
+    // The HUD bar is the bottom 100 pixels of the window, and its buttons never move
+    const float hudY = (float) height - 100.0f + 16.0f;
+    for (sf::Sprite *faceSprite : {&happyFaceSprite, &winFaceSprite, &loseFaceSprite}) {
+        faceSprite->setPosition(((float) width / 2.0f) - 32.0f, hudY);
+    }
+    debugSprite.setPosition((float) width - 304.0f, hudY);
+    pauseSprite.setPosition((float) width - 240.0f, hudY);
+    playSprite.setPosition((float) width - 240.0f, hudY);
+    leaderBoardSprite.setPosition((float) width - 176.0f, hudY);
+    // The board is drawn through a camera into the window above the HUD bar.
+    // The camera can zoom out until the whole board is in view.
+    const sf::Vector2f boardSize((float) numCols * 32.0f, (float) numRows * 32.0f);
+    const float fitZoom = std::max(boardSize.x / (float) width, boardSize.y / ((float) height - 100.0f));
+    Camera camera(boardSize, window.getSize(), sf::FloatRect(0.0f, 0.0f, (float) width, (float) height - 100.0f),
+                  fitZoom);
+    // From this zoom on (tiles 8 px or smaller on screen) the board is drawn from the one-pixel-per-cell LOD image
+    const float LOD_ZOOM = 4.0f;
+    BoardLod boardLod(32);
+    // Boards that don't fit in the window get the LOD view and a minimap in the HUD bar, between the mine counter
+    // and the face, sized to the board's aspect ratio
+    const bool scrollable = fitZoom > 1.0f;
+    const sf::FloatRect minimapBox(140.0f, (float) height - 100.0f + 8.0f, (float) width / 2.0f - 48.0f - 140.0f, 84.0f);
+    const bool showMinimap = scrollable && minimapBox.width >= 32.0f;
+    const float minimapScale = std::min(minimapBox.width / boardSize.x, minimapBox.height / boardSize.y);
+    sf::RectangleShape minimapFrame(sf::Vector2f(boardSize.x * minimapScale, boardSize.y * minimapScale));
+    minimapFrame.setPosition(minimapBox.left, minimapBox.top);
+    minimapFrame.setFillColor(sf::Color::Transparent);
+    minimapFrame.setOutlineColor(sf::Color::Black);
+    minimapFrame.setOutlineThickness(1.0f);
+    sf::RectangleShape minimapView;
+    minimapView.setFillColor(sf::Color::Transparent);
+    minimapView.setOutlineColor(sf::Color::Red);
+    minimapView.setOutlineThickness(1.0f);
+    // Set when the camera moved, so the tiles in view need to be brought up to date
+    bool cameraMoved = true;
+    // Middle-button drag scrolls the board
+    bool panning = false;
+    sf::Vector2i panFrom;
+    // Input and latency statistics, shown over the board in debug mode
+    LatencyProbe latency;
+    if (!latencyCsv.empty() && !latency.openCsv(latencyCsv)) {
+        std::cerr << "Failed to open " << latencyCsv << " for latency samples" << std::endl;
+    }
+    sf::Text statsText("", font, 12);
+    statsText.setFillColor(sf::Color::Black);
+    statsText.setPosition(8.0f, 6.0f);
+    sf::RectangleShape statsBg;
+    statsBg.setFillColor(sf::Color(255, 255, 255, 200));
+    statsBg.setPosition(4.0f, 4.0f);
+
+    /**
+     * Scenes: the name prompt, then the game, with the leaderboard as an overlay over the game
+     */
+    SceneStack scenes;
+    Scene welcomeScene;
+    Scene gameScene;
+    Scene leaderboardScene(true);
+    int exitCode = 0;
+
+    // Leaderboard overlay: a panel over the middle of the dimmed board
+    sf::RectangleShape leaderboardShade(sf::Vector2f((float) width, (float) height));
+    leaderboardShade.setFillColor(sf::Color(0, 0, 0, 120));
+    sf::RectangleShape leaderboardPanel(sf::Vector2f((float) width / 2.0f, (float) height / 2.0f));
+    leaderboardPanel.setPosition((float) width / 4.0f, (float) height / 4.0f);
+    leaderboardPanel.setFillColor(sf::Color::Blue);
+    sf::Text leaderboardTitle("LEADERBOARD", font, 20);
+    leaderboardTitle.setStyle(sf::Text::Bold | sf::Text::Underlined);
+    leaderboardTitle.setFillColor(sf::Color::White);
+    setText(leaderboardTitle, (float) width / 2.0f, (float) height / 2.0f - 120);
+    sf::Text leaderboardText("", font, 18);
+    leaderboardText.setStyle(sf::Text::Bold);
+    leaderboardText.setFillColor(sf::Color::White);
+    // Set when the leaderboard paused the game, so closing it resumes the game
+    bool resumeAfterLeaderboard = false;
+    // Scores come from the leaderboard's memory; only other game instances' changes are read from disk
+    auto showLeaderboardText = [&]() {
+        leaderboard.refresh();
+        leaderboardText.setString(leaderBoardText(leaderboard, name));
+        setText(leaderboardText, (float) width / 2.0f, (float) height / 2.0f + 20);
+    };
+    auto openLeaderboard = [&](bool resume) {
+        showLeaderboardText();
+        resumeAfterLeaderboard = resume;
+        scenes.push(leaderboardScene);
+        frameDirty = true;
+    };
+    // Any click or key closes the leaderboard
+    auto closeLeaderboard = [&](const TimedEvent &timed) {
+        scenes.pop();
+        if (resumeAfterLeaderboard) {
+            game.setPaused(false);
+            start_time += timed.received - pauseTime;
+            boardDirty = true;
+        }
+        frameDirty = true;
+    };
+    leaderboardScene.on(sf::Event::MouseButtonPressed, closeLeaderboard);
+    leaderboardScene.on(sf::Event::KeyPressed, closeLeaderboard);
+    leaderboardScene.onDraw([&](sf::RenderTarget &target) {
+        target.draw(leaderboardShade);
+        target.draw(leaderboardPanel);
+        target.draw(leaderboardTitle);
+        target.draw(leaderboardText);
+    });
+
+    // Entering the name starts the game in the same window
+    auto startGame = [&](std::chrono::high_resolution_clock::time_point entered) {
+        nameEnteredTime = entered;
+        // capitalize first letter, lowercase the rest
+        if (!name.empty()) {
+            name[0] = (char) std::toupper(name[0]);
+            for (int i = 1; i < name.size(); i++) {
+                name[i] = (char) std::tolower(name[i]);
             }
-            // Handle right click
-            if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
-                if (event.mouseButton.y <= height - 100) {
-                    int row = event.mouseButton.y / 32; // Calculate row based on mouse y-coordinate
-                    int col = event.mouseButton.x / 32; // Calculate column based on mouse x-coordinate
-                    if (tileState[row][col] == TileState::Hidden) {
-                        tileState[row][col] = TileState::Flagged;
-                        mineCount--; // Decrease mine count
-                    } else if (tileState[row][col] == TileState::Flagged) {
-                        tileState[row][col] = TileState::Hidden;
-                        mineCount++; // Increase mine count
-                    }
-                }
+        }
+        // The atlas has usually been composed while the name was typed; this waits for it if not
+        if (!assets.wait("atlas") || !atlas.upload()) {
+            exitCode = 1;
+            window.close();
+            return;
+        }
+        for (const auto &hudSprite : hudSprites) {
+            hudSprite.first->setTexture(atlasTexture);
+            hudSprite.first->setTextureRect(atlas.rect(hudSprite.second));
+        }
+        start_time = std::chrono::high_resolution_clock::now();
+        scenes.show(gameScene);
+        frameDirty = true;
+    };
+    welcomeScene.on(sf::Event::TextEntered, [&](const TimedEvent &timed) {
+        const sf::Uint32 unicode = timed.event.text.unicode;
+        if ((unicode >= 'A' && unicode <= 'Z') || (unicode >= 'a' && unicode <= 'z') && name.size() < 11) {
+            name.pop_back();
+            name += static_cast<char>(unicode);
+            name.push_back('|');     //Extra character for cursor
+        } else if (unicode == '\b') {
+            if (!name.empty()) {
+                name.pop_back();    //To pop the cursor
+                name.pop_back();    //To pop the character
+                name.push_back('|');
             }
         }
-        // Check if the player has won
-        if (tilesRevealed == (numRows * numCols) - mineCount) {
-            gameState = GameState::Win;
-            for (int i = 0; i < numRows; i++) {
-                for (int j = 0; j < numCols; j++) {
-                    if (gameBoard[i][j] == -1) {
-                        tileState[i][j] = TileState::Flagged;
-                        mineCount--;
-                        sf::Sprite s = hiddenSprite;
-                        s.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                        gameWindow.draw(s);
-                        s = flagSprite;
-                        s.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                        gameWindow.draw(s);
-                    }
+        inputText.setString(name);
+        setText(inputText, (float) window.getSize().x / 2.0f, (float) window.getSize().y / 2.0f - 35);
+        frameDirty = true;
+    });
+    welcomeScene.on(sf::Event::KeyPressed, [&](const TimedEvent &timed) {
+        if (name.size() > 1 && timed.event.key.code == sf::Keyboard::Enter) {
+            name.pop_back();
+            startGame(timed.received);
+        }
+    });
+    welcomeScene.onDraw([&](sf::RenderTarget &target) {
+        target.clear(sf::Color::Blue); // set the background color to blue
+        target.draw(welcomeText);
+        target.draw(inputPromptText);
+        target.draw(inputText);
+    });
+
+    /**
+     * Input handlers: window events here, everything else goes to the scene on top
+     */
+    InputDispatcher input;
+    input.on(sf::Event::Closed, [&window](const TimedEvent &) {
+        window.close();
+    });
+    auto redraw = [&frameDirty](const TimedEvent &) {
+        frameDirty = true;
+    };
+    input.on(sf::Event::GainedFocus, redraw);
+    input.on(sf::Event::Resized, redraw);
+    input.onAny([&scenes](const TimedEvent &timed) {
+        scenes.handle(timed);
+    });
+    gameScene.on(sf::Event::MouseButtonPressed, [&](const TimedEvent &timed) {
+        const sf::Event::MouseButtonEvent &click = timed.event.mouseButton;
+        const float x = (float) click.x;
+        const float y = (float) click.y;
+        if (click.button == sf::Mouse::Middle) {
+            panning = true;
+            panFrom = sf::Vector2i(click.x, click.y);
+            return;
+        }
+        latency.begin(timed.received);
+        // Restart, pause and debug all change how the tiles look
+        frameDirty = true;
+        boardDirty = true;
+        // Click listeners for the tiles
+        if (camera.inViewport(sf::Vector2i(click.x, click.y))) {
+            sf::Vector2f world = camera.toWorld(sf::Vector2i(click.x, click.y));
+            int row = (int) std::floor(world.y / 32.0f); // Calculate row based on mouse y-coordinate
+            int col = (int) std::floor(world.x / 32.0f); // Calculate column based on mouse x-coordinate
+            if (click.button == sf::Mouse::Left) {
+                bool wasCommitted = game.layoutCommitted();
+                game.reveal(row, col);
+                if (!wasCommitted && game.layoutCommitted() && isDebugging) {
+                    // Debug mode draws every mine, so the committed layout is redrawn in full
+                    game.markAllChanged();
+                }
+                if (!wasCommitted && game.layoutCommitted() && game.board().size() <= 100 * 100) {
+                    // For debugging
+                    std::cout << "Seed: " << encodeSeed(game.seed()) << ", first click: " << row << "," << col
+                              << std::endl;
+                    display(game.board());
                 }
+            } else if (click.button == sf::Mouse::Right) {
+                game.toggleFlag(row, col);
             }
-            elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(
-                    std::chrono::high_resolution_clock::now() - start_time).count();
-            int time_elapsed = (int) elapsed_time;
-            insert_score(time_elapsed, name, addedNewScore);
-            addedNewScore = true;
+            // Check if the player has won; the time is taken when the winning click arrived
+            if (game.state() == GameState::Win && !addedNewScore) {
+                elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(timed.received - start_time).count();
+                int time_elapsed = (int) elapsed_time;
+                insert_score(leaderboard, time_elapsed, name, addedNewScore);
+                addedNewScore = true;
+            }
+            return;
         }
-        // Set the background color of the game window to white
-        gameWindow.clear(sf::Color::White);
-        // Draw the tiles
-        for (int i = 0; i < numRows; i++) {
-            for (int j = 0; j < numCols; j++) {
-                sf::Sprite sprite = hiddenSprite;
-                if (gameState == GameState::Paused) {
-                    sprite = revealedSprite;
-                    sprite.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                    gameWindow.draw(sprite);
-                    continue;
-                }
-                // Determine which sprite to use for the tile
-
-                if (tileState[i][j] == TileState::Revealed) {
-                    sprite = revealedSprite;
-                    // Set the position of the sprite
-                    sprite.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                    // Draw the sprite
-                    gameWindow.draw(sprite);
-                    if (gameBoard[i][j] > 0) {
-                        // Determine which number sprite to use for the tile
-                        sprite = numberSprites[gameBoard[i][j] - 1];
-                    }
-                    if (gameBoard[i][j] == -1) {
-                        sprite = mineSprite;
-                    }
-                } else {
-                    sprite = hiddenSprite;
-                    //If the game is in debug mode then draw the mines, too.
-                    if (isDebugging) {
-                        // Set the position of the sprite
-                        sprite.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                        // Draw the sprite
-                        gameWindow.draw(sprite);
-                        if (gameBoard[i][j] == -1) {
-                            sprite = mineSprite;
-                        }
-                    }
+        //Click listeners for bottom buttons
+        if (click.button != sf::Mouse::Left) {
+            return;
+        }
+        // A click on the minimap centres the camera there
+        if (showMinimap && minimapFrame.getGlobalBounds().contains(x, y)) {
+            camera.centerOn(sf::Vector2f((x - minimapBox.left) / minimapScale, (y - minimapBox.top) / minimapScale));
+            cameraMoved = true;
+            return;
+        }
+        // Check if the click was on the face button
+        if (happyFaceSprite.getGlobalBounds().contains(x, y)) {
+            //Restart the game
+            game.start(boardPool);
+            seedText.setString(encodeSeed(game.seed()));
+            addedNewScore = false;
+            isDebugging = false;
+            closed = false;
+            start_time = std::chrono::high_resolution_clock::now();
+        }
+        // If the user has not won the game:
+        if (!game.isOver()) {
+            // Check if the click was on the debug button
+            if (debugSprite.getGlobalBounds().contains(x, y)) {
+                isDebugging = !isDebugging;
+            }
+            // Check if the click was on the pause/play button
+            if (playSprite.getGlobalBounds().contains(x, y)) {
+                if (game.state() == GameState::Paused) {
+                    game.setPaused(false);
+                    start_time += timed.received - pauseTime;
+                } else if (game.state() == GameState::InProgress) {
+                    game.setPaused(true);
+                    //Note down the time when the game was paused
+                    pauseTime = timed.received;
                 }
-                // Set the position of the sprite
-                sprite.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                // Draw the sprite
-                gameWindow.draw(sprite);
-                //if it is Flagged then first draw the hiddenSpite then on top of it draw the flagSprite
-                if (tileState[i][j] == TileState::Flagged) {
-                    flagSprite.setPosition((float) j * 32.0f, (float) i * 32.0f);
-                    gameWindow.draw(flagSprite);
+            }
+            // Check if the click was on the leaderboard button; a running game is paused while it is up
+            if (leaderBoardSprite.getGlobalBounds().contains(x, y)) {
+                const bool wasRunning = game.state() == GameState::InProgress;
+                if (wasRunning) {
+                    game.setPaused(true);
+                    pauseTime = timed.received;
                 }
+                openLeaderboard(wasRunning);
             }
         }
-        if (showLeaderBoard) {
-            displayLeaderBoard(width, height, font, name);
-            start_time += std::chrono::high_resolution_clock::now() - pauseTime;
-            gameState = GameState::InProgress;
-            showLeaderBoard = false;
+    });
+
+    /**
+     * Camera controls: middle-drag or the arrow keys scroll, the wheel or +/- zoom, Home goes back to 1:1
+     */
+    auto moveCamera = [&cameraMoved, &frameDirty]() {
+        cameraMoved = true;
+        frameDirty = true;
+    };
+    gameScene.on(sf::Event::MouseButtonReleased, [&panning](const TimedEvent &timed) {
+        if (timed.event.mouseButton.button == sf::Mouse::Middle) {
+            panning = false;
+        }
+    });
+    gameScene.on(sf::Event::MouseMoved, [&](const TimedEvent &timed) {
+        if (!panning) {
+            return;
+        }
+        sf::Vector2i to(timed.event.mouseMove.x, timed.event.mouseMove.y);
+        // Dragging moves the board with the cursor, so the view moves the other way
+        camera.pan(sf::Vector2f((float) (panFrom.x - to.x), (float) (panFrom.y - to.y)));
+        panFrom = to;
+        moveCamera();
+    });
+    gameScene.on(sf::Event::MouseWheelScrolled, [&](const TimedEvent &timed) {
+        const sf::Event::MouseWheelScrollEvent &scroll = timed.event.mouseWheelScroll;
+        if (scroll.wheel != sf::Mouse::VerticalWheel || !camera.inViewport(sf::Vector2i(scroll.x, scroll.y))) {
+            return;
         }
-        // Check if there's a need to open leaderboard window
-        if (showInNextIter) {
-            //Open the leaderboard window
-            showLeaderBoard = true;
-            showInNextIter = false;
+        // Scrolling up zooms in around the cursor
+        camera.zoomAt(sf::Vector2i(scroll.x, scroll.y), std::pow(1.1f, -scroll.delta));
+        moveCamera();
+    });
+    gameScene.on(sf::Event::KeyPressed, [&](const TimedEvent &timed) {
+        const float step = 4.0f * 32.0f;
+        const sf::Vector2i centre(width / 2, (height - 100) / 2);
+        switch (timed.event.key.code) {
+            case sf::Keyboard::Left:
+                camera.pan(sf::Vector2f(-step, 0.0f));
+                break;
+            case sf::Keyboard::Right:
+                camera.pan(sf::Vector2f(step, 0.0f));
+                break;
+            case sf::Keyboard::Up:
+                camera.pan(sf::Vector2f(0.0f, -step));
+                break;
+            case sf::Keyboard::Down:
+                camera.pan(sf::Vector2f(0.0f, step));
+                break;
+            case sf::Keyboard::Add:
+            case sf::Keyboard::Equal:
+                camera.zoomAt(centre, 1.0f / 1.25f);
+                break;
+            case sf::Keyboard::Subtract:
+            case sf::Keyboard::Hyphen:
+                camera.zoomAt(centre, 1.25f);
+                break;
+            case sf::Keyboard::Home:
+                camera.reset();
+                break;
+            default:
+                return;
         }
+        moveCamera();
+    });
+
+    gameScene.onDraw([&](sf::RenderTarget &target) {
+        // Set the background color of the game window to white
+        target.clear(sf::Color::White);
+        // Hand what the last moves changed to the renderers
+        const bool paused = game.state() == GameState::Paused;
+        boardRenderer.invalidate(game.changes());
+        if (scrollable) {
+            boardLod.update(gameBoard, paused, isDebugging, game.changes());
+        }
+        game.clearChanges();
+        // Draw the tiles the camera can see, or the LOD image when zoomed far out
+        const bool lodView = scrollable && camera.zoom() >= LOD_ZOOM;
+        if (!lodView && (boardDirty || cameraMoved)) {
+            boardRenderer.update(gameBoard, paused, isDebugging, camera.visibleArea());
+            boardDirty = false;
+            cameraMoved = false;
+        }
+        latency.mark(LatencyProbe::Vertices);
+        target.setView(camera.view());
+        if (lodView) {
+            target.draw(boardLod);
+        } else {
+            target.draw(boardRenderer);
+        }
+        // The HUD is drawn in window pixels
+        target.setView(target.getDefaultView());
         // Draw the face button
         sf::Sprite faceSprite = happyFaceSprite;
-        if (gameState == GameState::Win) {
+        if (game.state() == GameState::Win) {
             faceSprite = winFaceSprite;
-        } else if (gameState == GameState::Lose) {
+        } else if (game.state() == GameState::Lose) {
             faceSprite = loseFaceSprite;
         }
-        faceSprite.setPosition(((float) numCols / 2.0f * 32.0f) - 32.0f, 32.0f * ((float) numRows + 0.5f));
-        gameWindow.draw(faceSprite);
+        target.draw(faceSprite);
 
         // Draw the debug button
-        debugSprite.setPosition((float) numCols * 32.0f - 304.0f, 32.0f * ((float) numRows + 0.5f));
-        gameWindow.draw(debugSprite);
+        target.draw(debugSprite);
 
         // Draw the pause/play button
         sf::Sprite pausePlaySprite = playSprite;
-        if (gameState == GameState::Paused) {
+        if (game.state() == GameState::Paused) {
             pausePlaySprite = pauseSprite;
         }
-        pausePlaySprite.setPosition((float) numCols * 32.0f - 240.0f, 32.0f * ((float) numRows + 0.5f));
-        gameWindow.draw(pausePlaySprite);
+        target.draw(pausePlaySprite);
         // Draw the leaderboard button
-        leaderBoardSprite.setPosition((float) numCols * 32.0f - 176.0f, 32.0f * ((float) numRows + 0.5f));
-        gameWindow.draw(leaderBoardSprite);
-
-        //Click listeners for bottom buttons
-        if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left) {
-            // Check if the click was on the face button
-            if (faceSprite.getGlobalBounds().contains((float) event.mouseButton.x, (float) event.mouseButton.y)) {
-                //Restart the game
-                initGame(gameBoard, tileState, numRows, numCols, MINE_COUNT);
-                tilesRevealed = 0;
-                addedNewScore = false;
-                isDebugging = false;
-                closed = false;
-                gameState = GameState::InProgress;
-                mineCount = MINE_COUNT;
-                start_time = std::chrono::high_resolution_clock::now();
-            }
-            // If the user has not won the game:
-            if (gameState != GameState::Win && gameState != GameState::Lose) {
-                // Check if the click was on the debug button
-                if (debugSprite.getGlobalBounds().contains((float) event.mouseButton.x, (float) event.mouseButton.y)) {
-                    isDebugging = !isDebugging;
-                }
-                // Check if the click was on the pause/play button
-                if (pausePlaySprite.getGlobalBounds().contains((float) event.mouseButton.x,
-                                                               (float) event.mouseButton.y)) {
-                    if (gameState == GameState::Paused) {
-                        gameState = GameState::InProgress;
-                        start_time += std::chrono::high_resolution_clock::now() - pauseTime;
-                    } else if (gameState == GameState::InProgress) {
-                        gameState = GameState::Paused;
-                        //Note down the time when the game was paused
-                        pauseTime = std::chrono::high_resolution_clock::now();
-                    }
-                }
-                // Check if the click was on the leaderboard button
-                if (leaderBoardSprite.getGlobalBounds().contains((float) event.mouseButton.x,
-                                                                 (float) event.mouseButton.y)) {
-                    gameState = GameState::Paused;
-                    pauseTime = std::chrono::high_resolution_clock::now();
-                    //Open the leaderboard window
-                    showInNextIter = true;
-                }
-            }
+        target.draw(leaderBoardSprite);
+
+        // Draw the minimap with the camera's view outlined on it
+        if (showMinimap) {
+            sf::Sprite minimap(boardLod.texture());
+            const float pixelScale = minimapScale * 32.0f * (float) boardLod.scale();
+            minimap.setScale(pixelScale, pixelScale);
+            minimap.setPosition(minimapBox.left, minimapBox.top);
+            target.draw(minimap);
+            target.draw(minimapFrame);
+            sf::FloatRect visible = camera.visibleArea();
+            minimapView.setPosition(minimapBox.left + std::max(visible.left, 0.0f) * minimapScale,
+                                    minimapBox.top + std::max(visible.top, 0.0f) * minimapScale);
+            minimapView.setSize(sf::Vector2f(std::min(visible.width, boardSize.x) * minimapScale,
+                                             std::min(visible.height, boardSize.y) * minimapScale));
+            target.draw(minimapView);
         }
 
+        // Draw the seed code
+        target.draw(seedText);
+
         // Draw the mine counter
-        sf::Vector2f counterPos(33.0f, 32 * ((float) numRows + 0.5f) + 16);
+        sf::Vector2f counterPos(33.0f, hudY + 16.0f);
         std::string counter = "000";
-        int tCount = abs(mineCount);
+        int tCount = abs(game.minesRemaining());
         int idx = 2;
         while (idx >= 0) {
             int digit = tCount % 10;
             counter[idx--] = (char) ('0' + digit);
             tCount /= 10;
         }
-        tCount = mineCount;
+        tCount = game.minesRemaining();
         if (tCount < 0) {
             // Draw the negative sign sprite
-            sf::Sprite negativeSprite(digitsTexture);
-            negativeSprite.setTextureRect(sf::IntRect(10 * 21, 0, 21, 32));
+            sf::Sprite negativeSprite(atlasTexture, atlas.digit(Atlas::MINUS_DIGIT));
             negativeSprite.setPosition(counterPos.x, counterPos.y);
-            gameWindow.draw(negativeSprite);
+            target.draw(negativeSprite);
             // Update the position for the next digit sprite
             counterPos.x += 21;
             // Make remainingMines positive for drawing the digits
@@ -678,17 +699,16 @@ int main() {
         idx = 0;
         while (idx < 3) {
             int digit = counter[idx++] - '0';
-            sf::Sprite digitSprite(digitsTexture);
-            digitSprite.setTextureRect(sf::IntRect(digit * 21, 0, 21, 32));
+            sf::Sprite digitSprite(atlasTexture, atlas.digit(digit));
             digitSprite.setPosition(counterPos.x, counterPos.y);
-            gameWindow.draw(digitSprite);
+            target.draw(digitSprite);
             // Update the position for the next digit sprite
             counterPos.x += 21;
             tCount /= 10;
         }
 
         // Calculate elapsed time
-        if (gameState == GameState::InProgress) {
+        if (game.state() == GameState::InProgress) {
             elapsed_time = std::chrono::duration_cast<std::chrono::seconds>(
                     std::chrono::high_resolution_clock::now() - start_time).count();
         }
@@ -696,35 +716,103 @@ int main() {
         // Draw the timer
         int minutes = timeElapsed / 60;
         int seconds = timeElapsed % 60;
-        sf::Vector2f minutesPos(((float) numCols * 32.0f) - 97, 32 * ((float) numRows + 0.5f) + 16);
-        sf::Vector2f secondsPos(((float) numCols * 32.0f) - 54, 32 * ((float) numRows + 0.5f) + 16);
+        sf::Vector2f minutesPos((float) width - 97, hudY + 16.0f);
+        sf::Vector2f secondsPos((float) width - 54, hudY + 16.0f);
         // Draw the minutes digits
         int digit = minutes / 10;
-        sf::Sprite digitSprite(digitsTexture);
-        digitSprite.setTextureRect(sf::IntRect(digit * 21, 0, 21, 32));
+        sf::Sprite digitSprite(atlasTexture, atlas.digit(digit));
         digitSprite.setPosition(minutesPos.x, minutesPos.y);
-        gameWindow.draw(digitSprite);
+        target.draw(digitSprite);
         digit = minutes % 10;
-        digitSprite.setTextureRect(sf::IntRect(digit * 21, 0, 21, 32));
+        digitSprite.setTextureRect(atlas.digit(digit));
         digitSprite.setPosition(minutesPos.x + 21, minutesPos.y);
-        gameWindow.draw(digitSprite);
+        target.draw(digitSprite);
         // Draw the seconds digits
         digit = seconds / 10;
-        digitSprite.setTextureRect(sf::IntRect(digit * 21, 0, 21, 32));
+        digitSprite.setTextureRect(atlas.digit(digit));
         digitSprite.setPosition(secondsPos.x, secondsPos.y);
-        gameWindow.draw(digitSprite);
+        target.draw(digitSprite);
         digit = seconds % 10;
-        digitSprite.setTextureRect(sf::IntRect(digit * 21, 0, 21, 32));
+        digitSprite.setTextureRect(atlas.digit(digit));
         digitSprite.setPosition(secondsPos.x + 21, secondsPos.y);
-        gameWindow.draw(digitSprite);
+        target.draw(digitSprite);
+
+        // Latency overlay
+        if (isDebugging) {
+            statsText.setString("events/frame: " + std::to_string(input.lastFrameEvents()) + " (max " +
+                                std::to_string(input.maxFrameEvents()) + ")\nchunks: " +
+                                std::to_string(boardRenderer.visibleChunks()) + " visible, " +
+                                std::to_string(boardRenderer.rebuiltChunks()) + " rebuilt, " +
+                                std::to_string(boardRenderer.cachedChunks()) + " cached\n" + latency.report());
+            sf::FloatRect bounds = statsText.getLocalBounds();
+            statsBg.setSize(sf::Vector2f(bounds.width + 10.0f, bounds.height + 12.0f));
+            target.draw(statsBg);
+            target.draw(statsText);
+        }
+    });
+
+    //Main looper
+    scenes.show(welcomeScene);
+    while (window.isOpen()) {
+        // Only a running game changes on its own (the timer); everything else waits for input
+        const bool timerRunning = scenes.contains(gameScene) && game.state() == GameState::InProgress;
+        // An open leaderboard also changes when another game instance saves a score
+        const bool leaderboardUp = scenes.contains(leaderboardScene);
+        bool scoresChanged = false;
+        if (input.poll(window) == 0 && !frameDirty) {
+            if (timerRunning || leaderboardUp) {
+                // Nap until there is input, the next second is due or the scores changed
+                while (input.poll(window) == 0 && timerSeconds() == shownSeconds &&
+                       !(leaderboardUp && (scoresChanged = leaderboard.refresh()))) {
+                    sf::sleep(idleSlice);
+                }
+            } else {
+                // Nothing changes on its own, so block until there is input
+                input.wait(window);
+            }
+        }
+        // Every queued event reaches the scene on top, in order, before the frame is drawn
+        input.dispatch();
+        latency.mark(LatencyProbe::Engine);
+        if (!window.isOpen()) {
+            break;
+        }
+        if (scenes.contains(gameScene) && timerSeconds() != shownSeconds) {
+            frameDirty = true;
+        }
+        // Scores won in other game instances show up while the leaderboard is open
+        if (scenes.contains(leaderboardScene) && (leaderboard.refresh() || scoresChanged)) {
+            showLeaderboardText();
+            frameDirty = true;
+        }
+        if (!frameDirty) {
+            // Mouse moves and other events that change nothing on screen
+            continue;
+        }
+        scenes.draw(window);
 
         // Display everything that has been drawn
-        gameWindow.display();
+        latency.mark(LatencyProbe::Submit);
+        window.display();
+        latency.finish();
+        input.endFrame();
+        if (!firstFrameShown && scenes.contains(gameScene)) {
+            firstFrameShown = true;
+            auto sinceLaunch = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::high_resolution_clock::now() - launchTime).count();
+            auto sinceName = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::high_resolution_clock::now() - nameEnteredTime).count();
+            std::cout << "First game frame " << sinceName << " ms after entering the name (" << sinceLaunch
+                      << " ms after launch)" << std::endl;
+        }
+        shownSeconds = elapsed_time;
+        frameDirty = false;
 
-        if (!closed && gameState == GameState::Win) {
-            displayLeaderBoard(width, height, font, name);
+        // A win brings the leaderboard up over the finished board, once
+        if (!closed && game.state() == GameState::Win) {
             closed = true;
+            openLeaderboard(false);
         }
     }
-    return 0;
+    return exitCode;
 }